@@ -0,0 +1,24 @@
+#include "allocation_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// The replacements are kept out of line, so that GCC does not mistake the
+// pairing of malloc and free for a mismatch.
+[[gnu::noinline]] void*
+operator new (const size_t size) {
+    gpw::foundation::bench::allocation_count.fetch_add (1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc (size == 0 ? 1 : size)) return ptr;
+
+    throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] void
+operator delete (void* ptr) noexcept {
+    std::free (ptr);
+}
+
+[[gnu::noinline]] void
+operator delete (void* ptr, size_t) noexcept {
+    std::free (ptr);
+}
@@ -0,0 +1,21 @@
+//
+// allocation_counter.hpp
+//
+// Count of Heap Allocations Made by the Benchmarks
+//
+
+#ifndef __GPW_FOUNDATION_BENCH_ALLOCATION_COUNTER__
+#define __GPW_FOUNDATION_BENCH_ALLOCATION_COUNTER__
+
+#include <atomic>
+#include <cstddef>
+
+namespace gpw::foundation::bench {
+
+// Number of calls to the global operator new, which is replaced in
+// allocation_counter.cpp.
+inline std::atomic<size_t> allocation_count{0};
+
+}  // namespace gpw::foundation::bench
+
+#endif
@@ -0,0 +1,585 @@
+#include "allocation_counter.hpp"
+#include "digraph.hpp"
+#include "generators.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace gpw::foundation;
+using namespace gpw::foundation::bench;
+
+namespace {
+
+const std::vector<int64_t> graph_sizes{1 << 10, 1 << 14, 1 << 17};
+const std::vector<int64_t> graph_shapes{bench::random, bench::power_law, bench::chain};
+
+}  // namespace
+
+//
+// Core operations over random, power-law and chain graphs.
+// The first argument is the number of nodes, the second one the shape.
+//
+
+static void
+BM_CreateNode (benchmark::State& state) {
+    const auto labels = make_labels (static_cast<size_t> (state.range (0)));
+
+    for (auto _ : state) {
+        digraph<int> gr;
+        for (const auto& label : labels) {
+            gr.create_node (label);
+        }
+        benchmark::DoNotOptimize (gr.size());
+    }
+
+    state.SetItemsProcessed (state.iterations() * labels.size());
+}
+BENCHMARK (BM_CreateNode)->ArgsProduct ({graph_sizes})->Unit (benchmark::kMillisecond);
+
+static void
+BM_ConnectNode (benchmark::State& state) {
+    const auto n      = static_cast<size_t> (state.range (0));
+    const auto labels = make_labels (n);
+    const auto edges  = make_edges (static_cast<int> (state.range (1)), n);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto gr = std::make_unique<digraph<int>> (make_digraph (labels, {}));
+        state.ResumeTiming();
+
+        for (const auto& [head, tail] : edges) {
+            gr->connect_node (labels[head], labels[tail]);
+        }
+        benchmark::DoNotOptimize (gr->count_connections());
+
+        state.PauseTiming();
+        gr.reset();
+        state.ResumeTiming();
+    }
+
+    state.SetLabel (shape_name (static_cast<int> (state.range (1))));
+    state.SetItemsProcessed (state.iterations() * edges.size());
+}
+BENCHMARK (BM_ConnectNode)
+    ->ArgsProduct ({graph_sizes, graph_shapes})
+    ->Unit (benchmark::kMillisecond);
+
+// Half of the queries are existing edges, the other half random pairs.
+static void
+BM_IsConnected (benchmark::State& state) {
+    const auto n      = static_cast<size_t> (state.range (0));
+    const auto labels = make_labels (n);
+    const auto edges  = make_edges (static_cast<int> (state.range (1)), n);
+    const auto gr     = make_digraph (labels, edges);
+
+    std::vector<std::pair<size_t, size_t>> queries = make_queries (n, 1 << 12);
+    for (size_t i = 0; i < queries.size(); i += 2) {
+        queries[i] = edges[i % edges.size()];
+    }
+
+    for (auto _ : state) {
+        size_t hits = 0;
+        for (const auto& [h, t] : queries) {
+            hits += gr.is_connected (labels[h], labels[t]);
+        }
+        benchmark::DoNotOptimize (hits);
+    }
+
+    state.SetLabel (shape_name (static_cast<int> (state.range (1))));
+    state.SetItemsProcessed (state.iterations() * queries.size());
+}
+BENCHMARK (BM_IsConnected)->ArgsProduct ({graph_sizes, graph_shapes});
+
+// Removes a random node and restores it with its original edges, so that the
+// graph keeps its shape across iterations.
+static void
+BM_RemoveNodeByShape (benchmark::State& state) {
+    const auto n      = static_cast<size_t> (state.range (0));
+    const auto labels = make_labels (n);
+    const auto edges  = make_edges (static_cast<int> (state.range (1)), n);
+    auto       gr     = make_digraph (labels, edges);
+
+    std::vector<std::vector<node_id>> out (n);
+    std::vector<std::vector<node_id>> in (n);
+    for (const auto& [head, tail] : edges) {
+        out[head].push_back (tail);
+        in[tail].push_back (head);
+    }
+
+    std::mt19937                          gen{11};
+    std::uniform_int_distribution<size_t> dist{0, n - 1};
+
+    for (auto _ : state) {
+        const auto victim = dist (gen);
+        gr.remove_node (labels[victim]);
+
+        state.PauseTiming();
+        const auto id = gr.create_node (labels[victim]);
+        for (const auto tail : out[victim]) {
+            gr.connect_node (id, tail == victim ? id : tail);
+        }
+        for (const auto head : in[victim]) {
+            gr.connect_node (head == victim ? id : head, id);
+        }
+        state.ResumeTiming();
+    }
+
+    state.SetLabel (shape_name (static_cast<int> (state.range (1))));
+}
+BENCHMARK (BM_RemoveNodeByShape)->ArgsProduct ({graph_sizes, graph_shapes});
+
+// Full depth-first traversal from node 0.  The third argument is 1 when one
+// engine is reused across traversals, and 0 when each one builds its own.
+static void
+BM_DepthFirst (benchmark::State& state) {
+    const auto n      = static_cast<size_t> (state.range (0));
+    const auto labels = make_labels (n);
+    const auto gr     = make_digraph (labels, make_edges (static_cast<int> (state.range (1)), n));
+    const auto reuse  = state.range (2) == 1;
+
+    depth_first_search<int> engine{true, gr.id_bound()};
+    for (auto _ : state) {
+        size_t count = 0;
+        const auto counter = [&count] (const node<int>&) { ++count; };
+        if (reuse) {
+            gr.depth_first (engine, 0, counter);
+        }
+        else {
+            gr.depth_first (0, counter);
+        }
+        benchmark::DoNotOptimize (count);
+    }
+
+    state.SetLabel (
+        std::string{shape_name (static_cast<int> (state.range (1)))} + (reuse ? "/reused" : "")
+    );
+    state.SetItemsProcessed (state.iterations() * n);
+}
+BENCHMARK (BM_DepthFirst)->ArgsProduct ({graph_sizes, graph_shapes, {0, 1}});
+
+// Reachability queries between random pairs: breadth-first searches that stop
+// at the target, sharing one engine.
+static void
+BM_BreadthFirstQuery (benchmark::State& state) {
+    const auto n       = static_cast<size_t> (state.range (0));
+    const auto labels  = make_labels (n);
+    const auto gr      = make_digraph (labels, make_edges (static_cast<int> (state.range (1)), n));
+    const auto queries = make_queries (n, 64);
+
+    breadth_first_search<int> engine{true, gr.id_bound()};
+    for (auto _ : state) {
+        size_t hits = 0;
+        for (const auto& [head, tail] : queries) {
+            hits += !gr.breadth_first (engine, head, [tail] (const node<int>& n) {
+                return n.id() == tail ? visit::stop : visit::proceed;
+            });
+        }
+        benchmark::DoNotOptimize (hits);
+    }
+
+    state.SetLabel (shape_name (static_cast<int> (state.range (1))));
+    state.SetItemsProcessed (state.iterations() * queries.size());
+}
+BENCHMARK (BM_BreadthFirstQuery)->ArgsProduct ({graph_sizes, graph_shapes});
+
+// Shortest paths between random pairs, as `digraph::path` finds them.  The
+// third argument is 1 when the engine and the buffers are reused across
+// queries, and 0 when each query builds its own.  Reports the number of
+// allocations per query.
+static void
+BM_PathQuery (benchmark::State& state) {
+    const auto n       = static_cast<size_t> (state.range (0));
+    const auto labels  = make_labels (n);
+    const auto gr      = make_digraph (labels, make_edges (static_cast<int> (state.range (1)), n));
+    const auto queries = make_queries (n, 64);
+    const auto reuse   = state.range (2) == 1;
+
+    breadth_first_search<int> engine{true, gr.id_bound()};
+    std::vector<node_id>      parent;
+    std::vector<node_id>      path;
+
+    size_t allocations = 0;
+    size_t runs        = 0;
+    for (auto _ : state) {
+        const auto before = allocation_count.load();
+
+        size_t length = 0;
+        for (const auto& [head, tail] : queries) {
+            const auto h = static_cast<node_id> (head);
+            const auto t = static_cast<node_id> (tail);
+            if (reuse) {
+                gr.path (engine, parent, h, t, path);
+                length += path.size();
+            }
+            else {
+                length += gr.path (h, t).size();
+            }
+        }
+        benchmark::DoNotOptimize (length);
+
+        allocations += allocation_count.load() - before;
+        ++runs;
+    }
+
+    state.counters["allocations"] =
+        static_cast<double> (allocations) / static_cast<double> (runs * queries.size());
+    state.SetLabel (
+        std::string{shape_name (static_cast<int> (state.range (1)))} + (reuse ? "/reused" : "")
+    );
+    state.SetItemsProcessed (state.iterations() * queries.size());
+}
+BENCHMARK (BM_PathQuery)->ArgsProduct ({graph_sizes, graph_shapes, {0, 1}});
+
+// Topological sort of the graph with every edge turned towards the higher
+// id, which makes it acyclic.  The third argument selects the graph: 0 for
+// the mutable one and 1 for its frozen snapshot.
+static void
+BM_TopologicalSort (benchmark::State& state) {
+    const auto n     = static_cast<size_t> (state.range (0));
+    auto       edges = make_edges (static_cast<int> (state.range (1)), n);
+    for (auto& [head, tail] : edges) {
+        if (head > tail) std::swap (head, tail);
+    }
+    const auto gr     = make_digraph (make_labels (n), edges);
+    const auto frozen = gr.freeze();
+
+    for (auto _ : state) {
+        if (state.range (2) == 0) {
+            benchmark::DoNotOptimize (gr.topological_sort());
+        }
+        else {
+            benchmark::DoNotOptimize (topological_sort (frozen));
+        }
+    }
+
+    state.SetLabel (
+        std::string{shape_name (static_cast<int> (state.range (1)))}
+        + (state.range (2) == 0 ? "/mutable" : "/frozen")
+    );
+    state.SetItemsProcessed (state.iterations() * (n + gr.count_connections()));
+}
+BENCHMARK (BM_TopologicalSort)->ArgsProduct ({graph_sizes, graph_shapes, {0, 1}});
+
+//
+// Targeted benchmarks
+//
+
+// Builds a chain of `n` nodes.  With the label index, the cost per node is
+// constant and the whole construction should scale linearly.
+static void
+BM_DigraphConstruction (benchmark::State& state) {
+    const auto n      = static_cast<size_t> (state.range (0));
+    const auto labels = make_labels (n);
+
+    for (auto _ : state) {
+        digraph<int> gr;
+        for (const auto& label : labels) {
+            gr.create_node (label);
+        }
+        for (size_t i = 1; i < n; ++i) {
+            gr.connect_node (labels[i - 1], labels[i]);
+        }
+        benchmark::DoNotOptimize (gr.size());
+    }
+
+    state.SetComplexityN (state.range (0));
+}
+BENCHMARK (BM_DigraphConstruction)
+    ->RangeMultiplier (4)
+    ->Range (1 << 10, 1 << 18)
+    ->Unit (benchmark::kMillisecond)
+    ->Complexity (benchmark::oN);
+
+// Same construction with long URI-like labels sharing a common prefix.
+static void
+BM_DigraphConstructionLongLabels (benchmark::State& state) {
+    const auto n      = static_cast<size_t> (state.range (0));
+    auto       labels = make_labels (n);
+    for (auto& label : labels) {
+        label = "https://example.com/network/resources/items/" + label;
+    }
+
+    for (auto _ : state) {
+        digraph<int> gr;
+        for (const auto& label : labels) {
+            gr.create_node (label);
+        }
+        for (size_t i = 1; i < n; ++i) {
+            gr.connect_node (labels[i - 1], labels[i]);
+        }
+        benchmark::DoNotOptimize (gr.size());
+    }
+
+    state.SetComplexityN (state.range (0));
+}
+BENCHMARK (BM_DigraphConstructionLongLabels)
+    ->RangeMultiplier (4)
+    ->Range (1 << 10, 1 << 18)
+    ->Unit (benchmark::kMillisecond)
+    ->Complexity (benchmark::oN);
+
+// Mutable and frozen forms answering the same random edge queries.
+static void
+BM_IsConnectedMutable (benchmark::State& state) {
+    const auto n       = static_cast<size_t> (state.range (0));
+    const auto labels  = make_labels (n);
+    const auto gr      = make_random_digraph (labels, 8);
+    const auto queries = make_queries (n, 1 << 12);
+
+    for (auto _ : state) {
+        size_t hits = 0;
+        for (const auto& [h, t] : queries) {
+            hits += gr.is_connected (labels[h], labels[t]);
+        }
+        benchmark::DoNotOptimize (hits);
+    }
+
+    state.SetItemsProcessed (state.iterations() * queries.size());
+}
+BENCHMARK (BM_IsConnectedMutable)->RangeMultiplier (8)->Range (1 << 10, 1 << 16);
+
+static void
+BM_IsConnectedMutableById (benchmark::State& state) {
+    const auto n       = static_cast<size_t> (state.range (0));
+    const auto labels  = make_labels (n);
+    const auto gr      = make_random_digraph (labels, 8);
+    const auto queries = make_queries (n, 1 << 12);
+
+    for (auto _ : state) {
+        size_t hits = 0;
+        for (const auto& [h, t] : queries) {
+            hits += gr.is_connected (static_cast<node_id> (h), static_cast<node_id> (t));
+        }
+        benchmark::DoNotOptimize (hits);
+    }
+
+    state.SetItemsProcessed (state.iterations() * queries.size());
+}
+BENCHMARK (BM_IsConnectedMutableById)->RangeMultiplier (8)->Range (1 << 10, 1 << 16);
+
+static void
+BM_IsConnectedFrozen (benchmark::State& state) {
+    const auto n       = static_cast<size_t> (state.range (0));
+    const auto labels  = make_labels (n);
+    const auto csr     = make_random_digraph (labels, 8).freeze();
+    const auto queries = make_queries (n, 1 << 12);
+
+    for (auto _ : state) {
+        size_t hits = 0;
+        for (const auto& [h, t] : queries) {
+            hits += csr.is_connected (labels[h], labels[t]);
+        }
+        benchmark::DoNotOptimize (hits);
+    }
+
+    state.SetItemsProcessed (state.iterations() * queries.size());
+}
+BENCHMARK (BM_IsConnectedFrozen)->RangeMultiplier (8)->Range (1 << 10, 1 << 16);
+
+static void
+BM_IsConnectedFrozenById (benchmark::State& state) {
+    const auto n       = static_cast<size_t> (state.range (0));
+    const auto labels  = make_labels (n);
+    const auto csr     = make_random_digraph (labels, 8).freeze();
+    const auto queries = make_queries (n, 1 << 12);
+
+    for (auto _ : state) {
+        size_t hits = 0;
+        for (const auto& [h, t] : queries) {
+            hits += csr.is_connected (static_cast<node_id> (h), static_cast<node_id> (t));
+        }
+        benchmark::DoNotOptimize (hits);
+    }
+
+    state.SetItemsProcessed (state.iterations() * queries.size());
+}
+BENCHMARK (BM_IsConnectedFrozenById)->RangeMultiplier (8)->Range (1 << 10, 1 << 16);
+
+// Cost of packing a mutable graph into its frozen form.
+static void
+BM_Freeze (benchmark::State& state) {
+    const auto n      = static_cast<size_t> (state.range (0));
+    const auto labels = make_labels (n);
+    const auto gr     = make_random_digraph (labels, 8);
+
+    for (auto _ : state) {
+        auto csr = gr.freeze();
+        benchmark::DoNotOptimize (csr.count_connections());
+    }
+}
+BENCHMARK (BM_Freeze)
+    ->RangeMultiplier (8)
+    ->Range (1 << 10, 1 << 16)
+    ->Unit (benchmark::kMillisecond);
+
+// Power-law worst case: a single hub connected to every other node.
+static void
+BM_HubConnect (benchmark::State& state) {
+    const auto n      = static_cast<size_t> (state.range (0));
+    const auto labels = make_labels (n);
+
+    for (auto _ : state) {
+        digraph<int> gr;
+        for (const auto& label : labels) {
+            gr.create_node (label);
+        }
+        for (size_t i = 1; i < n; ++i) {
+            gr.connect_node (labels[0], labels[i]);
+        }
+        benchmark::DoNotOptimize (gr.count_connections());
+    }
+
+    state.SetComplexityN (state.range (0));
+}
+BENCHMARK (BM_HubConnect)
+    ->RangeMultiplier (4)
+    ->Range (1 << 10, 1 << 17)
+    ->Unit (benchmark::kMillisecond)
+    ->Complexity (benchmark::oN);
+
+static void
+BM_HubIsConnected (benchmark::State& state) {
+    const auto n       = static_cast<size_t> (state.range (0));
+    const auto labels  = make_labels (n);
+    const auto queries = make_queries (n, 1 << 12);
+
+    digraph<int> gr;
+    for (const auto& label : labels) {
+        gr.create_node (label);
+    }
+    for (size_t i = 1; i < n; i += 2) {
+        gr.connect_node (labels[0], labels[i]);
+    }
+
+    for (auto _ : state) {
+        size_t hits = 0;
+        for (const auto& query : queries) {
+            hits += gr.is_connected (labels[0], labels[query.second]);
+        }
+        benchmark::DoNotOptimize (hits);
+    }
+
+    state.SetItemsProcessed (state.iterations() * queries.size());
+}
+BENCHMARK (BM_HubIsConnected)->RangeMultiplier (8)->Range (1 << 10, 1 << 17);
+
+// Vertex churn: remove a node and create it again with fresh edges.
+static void
+BM_RemoveNode (benchmark::State& state) {
+    const auto n      = static_cast<size_t> (state.range (0));
+    const auto labels = make_labels (n);
+    auto       gr     = make_random_digraph (labels, 8);
+
+    std::mt19937                          gen{11};
+    std::uniform_int_distribution<size_t> dist{0, n - 1};
+
+    for (auto _ : state) {
+        const auto& label = labels[dist (gen)];
+        gr.remove_node (label);
+        gr.create_node (label);
+        for (int i = 0; i < 8; ++i) {
+            gr.connect_node (label, labels[dist (gen)]);
+            gr.connect_node (labels[dist (gen)], label);
+        }
+    }
+
+    state.SetComplexityN (state.range (0));
+}
+BENCHMARK (BM_RemoveNode)->RangeMultiplier (8)->Range (1 << 10, 1 << 16)->Complexity();
+
+// Construction through the id API: `range(0)` random edges over a tenth
+// as many nodes.  Reports the number of allocations per build.
+static void
+BM_BuildEdges (benchmark::State& state) {
+    const auto m      = static_cast<size_t> (state.range (0));
+    const auto n      = m / 10;
+    const auto labels = make_labels (n);
+
+    std::mt19937                          gen{3};
+    std::uniform_int_distribution<size_t> dist{0, n - 1};
+
+    std::vector<std::pair<node_id, node_id>> edges (m);
+    for (auto& edge : edges) {
+        edge = {static_cast<node_id> (dist (gen)), static_cast<node_id> (dist (gen))};
+    }
+
+    size_t allocations = 0;
+    for (auto _ : state) {
+        const auto before = allocation_count.load();
+        {
+            digraph<int> gr;
+            gr.reserve (n);
+            for (const auto& label : labels) {
+                gr.create_node (label);
+            }
+            for (const auto& [head, tail] : edges) {
+                gr.connect_node (head, tail);
+            }
+            benchmark::DoNotOptimize (gr.count_connections());
+
+            allocations = allocation_count.load() - before;
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+
+    state.counters["allocations"] = static_cast<double> (allocations);
+    state.SetItemsProcessed (state.iterations() * m);
+}
+BENCHMARK (BM_BuildEdges)
+    ->Arg (1'000'000)
+    ->Arg (10'000'000)
+    ->Unit (benchmark::kMillisecond)
+    ->Iterations (1);
+
+// The same kind of graph as `BM_BuildEdges`, loaded from label pairs:
+// node by node, and with the bulk builder.
+static void
+BM_LoadEdges (benchmark::State& state) {
+    const auto edges = make_label_edges (static_cast<size_t> (state.range (0)));
+
+    for (auto _ : state) {
+        digraph<int> gr;
+        for (const auto& [head, tail] : edges) {
+            gr.connect_node (gr.create_node (head), gr.create_node (tail));
+        }
+        benchmark::DoNotOptimize (gr.count_connections());
+    }
+
+    state.SetItemsProcessed (state.iterations() * edges.size());
+}
+BENCHMARK (BM_LoadEdges)->Arg (1'000'000)->Arg (10'000'000)->Unit (benchmark::kMillisecond);
+
+static void
+BM_FromEdges (benchmark::State& state) {
+    const auto edges = make_label_edges (static_cast<size_t> (state.range (0)));
+
+    for (auto _ : state) {
+        auto gr = digraph<int>::from_edges (edges);
+        benchmark::DoNotOptimize (gr.count_connections());
+    }
+
+    state.SetItemsProcessed (state.iterations() * edges.size());
+}
+BENCHMARK (BM_FromEdges)->Arg (1'000'000)->Arg (10'000'000)->Unit (benchmark::kMillisecond);
+
+// Cost of dropping a graph with `range(0)` random edges.
+static void
+BM_Teardown (benchmark::State& state) {
+    const auto m      = static_cast<size_t> (state.range (0));
+    const auto labels = make_labels (m / 10);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto gr = std::make_unique<digraph<int>> (make_random_digraph (labels, 10));
+        state.ResumeTiming();
+
+        gr.reset();
+    }
+}
+BENCHMARK (BM_Teardown)->Arg (1'000'000)->Unit (benchmark::kMillisecond)->Iterations (3);
@@ -0,0 +1,137 @@
+#include "dag_executor.hpp"
+#include "generators.hpp"
+#include "topological_sort.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace gpw::foundation;
+using namespace gpw::foundation::bench;
+
+namespace {
+
+// 64K tasks.  The random shape is a layered graph, 256 tasks wide, where each
+// task depends on two tasks of the layer before; the chain shape leaves no
+// room for parallelism and measures the cost of releasing a task alone.
+constexpr size_t task_count = 1 << 16;
+constexpr size_t task_width = 1 << 8;
+
+// Durations of a task, in nanoseconds: no work at all, and a microsecond.
+const std::vector<int64_t> task_durations{0, 1000};
+
+const csr_digraph<int>&
+task_graph (const int shape) {
+    static std::map<int, csr_digraph<int>> graphs;
+
+    auto iter = graphs.find (shape);
+    if (iter == graphs.end()) {
+        std::vector<std::pair<node_id, node_id>> edges;
+        if (shape == chain) {
+            edges = make_edges (chain, task_count);
+        }
+        else {
+            std::mt19937                          gen{42};
+            std::uniform_int_distribution<size_t> column{0, task_width - 1};
+            for (size_t i = task_width; i < task_count; ++i) {
+                const auto layer = i / task_width - 1;
+                for (int k = 0; k < 2; ++k) {
+                    const auto head = layer * task_width + column (gen);
+                    edges.emplace_back (static_cast<node_id> (head), static_cast<node_id> (i));
+                }
+            }
+        }
+        iter = graphs.emplace (shape, make_digraph (make_labels (task_count), edges).freeze())
+                   .first;
+    }
+    return iter->second;
+}
+
+// Busy work for `ns` nanoseconds, which keeps the thread on its core the way
+// a short computation would.
+void
+spin (const int64_t ns) {
+    if (ns == 0) return;
+
+    const auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds{ns};
+    while (std::chrono::steady_clock::now() < until) {
+    }
+}
+
+// 1, 2, 4, ... up to the number of hardware threads, and at least 8.
+std::vector<int64_t>
+thread_counts () {
+    std::vector<int64_t> counts;
+    const auto           limit = std::max<int64_t> (8, std::thread::hardware_concurrency());
+    for (int64_t t = 1; t <= limit; t *= 2) {
+        counts.push_back (t);
+    }
+    return counts;
+}
+
+}  // namespace
+
+//
+// Runs 64K fine-grained tasks in dependency order.  The time per task, set
+// against that of the sequential baseline below, is the scheduling overhead.
+// The arguments are the shape, the duration of a task in nanoseconds, and
+// the number of threads.
+//
+
+static void
+BM_DagExecutor (benchmark::State& state) {
+    const auto  shape    = static_cast<int> (state.range (0));
+    const auto  duration = state.range (1);
+    const auto& gr       = task_graph (shape);
+
+    work_stealing_pool      pool{static_cast<size_t> (state.range (2))};
+    dag_executor<int, void> executor{gr};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize (executor.run (pool, [duration] (node_id) { spin (duration); }));
+    }
+
+    state.SetLabel (std::string{shape_name (shape)} + "/" + std::to_string (duration) + "ns");
+    state.SetItemsProcessed (state.iterations() * gr.size());
+    state.counters["per_task"] = benchmark::Counter (
+        static_cast<double> (gr.size()),
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert
+    );
+}
+BENCHMARK (BM_DagExecutor)
+    ->ArgsProduct ({{bench::random, bench::chain}, task_durations, thread_counts()})
+    ->Unit (benchmark::kMillisecond)
+    ->UseRealTime();
+
+// The same tasks called one after the other in a precomputed topological
+// order, as a baseline with no scheduling at all.
+static void
+BM_SequentialTasks (benchmark::State& state) {
+    const auto  shape    = static_cast<int> (state.range (0));
+    const auto  duration = state.range (1);
+    const auto& gr       = task_graph (shape);
+    const auto  sorted   = topological_sort (gr);
+
+    for (auto _ : state) {
+        for (const auto id : sorted.order) {
+            benchmark::DoNotOptimize (id);
+            spin (duration);
+        }
+    }
+
+    state.SetLabel (std::string{shape_name (shape)} + "/" + std::to_string (duration) + "ns");
+    state.SetItemsProcessed (state.iterations() * gr.size());
+    state.counters["per_task"] = benchmark::Counter (
+        static_cast<double> (gr.size()),
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert
+    );
+}
+BENCHMARK (BM_SequentialTasks)
+    ->ArgsProduct ({{bench::random, bench::chain}, task_durations})
+    ->Unit (benchmark::kMillisecond);
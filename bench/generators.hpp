@@ -0,0 +1,207 @@
+//
+// generators.hpp
+//
+// Synthetic Inputs for the Benchmarks
+//
+
+#ifndef __GPW_FOUNDATION_BENCH_GENERATORS__
+#define __GPW_FOUNDATION_BENCH_GENERATORS__
+
+#include "digraph.hpp"
+#include "tree.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gpw::foundation::bench {
+
+// Shapes of the synthetic graphs and trees, passed to the benchmarks as their
+// second argument.
+enum shape : int { random, power_law, chain };
+
+inline const char*
+shape_name (const int s) {
+    switch (s) {
+    case random: return "random";
+    case power_law: return "power-law";
+    case chain: return "chain";
+    }
+    return "";
+}
+
+inline std::vector<std::string>
+make_labels (const size_t count) {
+    std::vector<std::string> labels;
+    labels.reserve (count);
+    for (size_t i = 0; i < count; ++i) {
+        labels.push_back ("node-" + std::to_string (i));
+    }
+    return labels;
+}
+
+// Edges over `n` nodes, about `degree` per node:
+// - random: both ends drawn uniformly;
+// - power-law: one end drawn uniformly and the other strongly skewed towards
+//   low ids, which gives a few hubs with very high in- or out-degree;
+// - chain: `i -> i + 1` only.
+inline std::vector<std::pair<node_id, node_id>>
+make_edges (const int s, const size_t n, const size_t degree = 8) {
+    std::vector<std::pair<node_id, node_id>> edges;
+    if (s == chain) {
+        for (size_t i = 1; i < n; ++i) {
+            edges.emplace_back (static_cast<node_id> (i - 1), static_cast<node_id> (i));
+        }
+        return edges;
+    }
+
+    std::mt19937                           gen{42};
+    std::uniform_int_distribution<node_id> uniform{0, static_cast<node_id> (n - 1)};
+    std::uniform_real_distribution<double> unit{0.0, 1.0};
+
+    const auto skewed = [&] {
+        return static_cast<node_id> (static_cast<double> (n - 1) * std::pow (unit (gen), 4.0));
+    };
+
+    edges.reserve (degree * n);
+    for (size_t i = 0; i < degree * n; ++i) {
+        if (s == random) {
+            edges.emplace_back (uniform (gen), uniform (gen));
+        }
+        else if (i % 2 == 0) {
+            edges.emplace_back (skewed(), uniform (gen));
+        }
+        else {
+            edges.emplace_back (uniform (gen), skewed());
+        }
+    }
+    return edges;
+}
+
+// Graph whose node `i` has label `labels[i]` and id `i`.
+inline digraph<int>
+make_digraph (
+    const std::vector<std::string>&                 labels,
+    const std::vector<std::pair<node_id, node_id>>& edges
+) {
+    digraph<int> gr;
+    gr.reserve (labels.size());
+    for (const auto& label : labels) {
+        gr.create_node (label);
+    }
+    for (const auto& [head, tail] : edges) {
+        gr.connect_node (head, tail);
+    }
+    return gr;
+}
+
+// Random graph with `labels.size()` nodes and about `degree` edges per node.
+inline digraph<int>
+make_random_digraph (const std::vector<std::string>& labels, const size_t degree) {
+    return make_digraph (labels, make_edges (random, labels.size(), degree));
+}
+
+// Random (head, tail) index pairs used as queries.
+inline std::vector<std::pair<size_t, size_t>>
+make_queries (const size_t n, const size_t count) {
+    std::mt19937                          gen{7};
+    std::uniform_int_distribution<size_t> dist{0, n - 1};
+
+    std::vector<std::pair<size_t, size_t>> queries;
+    queries.reserve (count);
+    for (size_t i = 0; i < count; ++i) {
+        queries.emplace_back (dist (gen), dist (gen));
+    }
+    return queries;
+}
+
+// `m` random edges over `m / 10` nodes, as label pairs.
+inline std::vector<std::pair<std::string, std::string>>
+make_label_edges (const size_t m) {
+    const auto labels = make_labels (m / 10);
+
+    std::mt19937                          gen{3};
+    std::uniform_int_distribution<size_t> dist{0, labels.size() - 1};
+
+    std::vector<std::pair<std::string, std::string>> edges (m);
+    for (auto& edge : edges) {
+        edge = {labels[dist (gen)], labels[dist (gen)]};
+    }
+    return edges;
+}
+
+// Road-network-like graph: a `side` x `side` grid whose neighbors are
+// connected both ways by roads of length 10 to 19.  Node `row * side + col`
+// is at (row, col), so ten times the Manhattan distance is a consistent
+// estimate for A*.
+inline csr_digraph<int, std::uint32_t>
+make_road_network (const size_t side) {
+    const auto labels = make_labels (side * side);
+
+    std::mt19937                                 gen{13};
+    std::uniform_int_distribution<std::uint32_t> length{10, 19};
+
+    digraph<int, std::uint32_t> gr;
+    gr.reserve (labels.size());
+    for (const auto& label : labels) {
+        gr.create_node (label);
+    }
+    for (size_t row = 0; row < side; ++row) {
+        for (size_t col = 0; col < side; ++col) {
+            const auto id = static_cast<node_id> (row * side + col);
+            if (col + 1 < side) {
+                gr.connect_node (id, id + 1, length (gen));
+                gr.connect_node (id + 1, id, length (gen));
+            }
+            if (row + 1 < side) {
+                const auto below = static_cast<node_id> (id + side);
+                gr.connect_node (id, below, length (gen));
+                gr.connect_node (below, id, length (gen));
+            }
+        }
+    }
+    return gr.freeze();
+}
+
+// Parent of every node but the root (node 0) of an `n`-node tree:
+// - random: any earlier node;
+// - power-law: an earlier node skewed towards the root, which gives a few
+//   nodes with very many children;
+// - chain: the previous node, for a tree as deep as it is large.
+inline std::vector<size_t>
+make_parents (const int s, const size_t n) {
+    std::mt19937                           gen{5};
+    std::uniform_real_distribution<double> unit{0.0, 1.0};
+
+    std::vector<size_t> parents (n, 0);
+    for (size_t i = 1; i < n; ++i) {
+        switch (s) {
+        case random:
+            parents[i] = static_cast<size_t> (unit (gen) * static_cast<double> (i));
+            break;
+        case power_law:
+            parents[i] = static_cast<size_t> (std::pow (unit (gen), 4.0) * static_cast<double> (i));
+            break;
+        case chain: parents[i] = i - 1; break;
+        }
+    }
+    return parents;
+}
+
+inline std::unique_ptr<tree<int>>
+make_tree (const std::vector<std::string>& labels, const std::vector<size_t>& parents) {
+    auto tr = std::make_unique<tree<int>> (labels[0]);
+    tr->reserve (labels.size());
+    for (size_t i = 1; i < labels.size(); ++i) {
+        tr->append_node (static_cast<node_id> (parents[i]), labels[i]);
+    }
+    return tr;
+}
+
+}  // namespace gpw::foundation::bench
+
+#endif
@@ -0,0 +1,253 @@
+#include "centrality.hpp"
+#include "generators.hpp"
+#include "page_rank.hpp"
+#include "parallel_bfs.hpp"
+#include "strong_components.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <list>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace gpw::foundation;
+using namespace gpw::foundation::bench;
+
+namespace {
+
+// 256K nodes with 16 edges each.
+constexpr size_t graph_size   = 1 << 18;
+constexpr size_t graph_degree = 16;
+
+// Building each graph takes a while, so it is built once per shape.
+const std::pair<digraph<int>, csr_digraph<int>>&
+scaling_graph (const int shape) {
+    static std::map<int, std::pair<digraph<int>, csr_digraph<int>>> graphs;
+
+    auto iter = graphs.find (shape);
+    if (iter == graphs.end()) {
+        auto gr = make_digraph (
+            make_labels (graph_size),
+            make_edges (shape, graph_size, graph_degree)
+        );
+        auto frozen = gr.freeze();
+        iter = graphs.emplace (shape, std::pair{std::move (gr), std::move (frozen)}).first;
+    }
+    return iter->second;
+}
+
+// 1, 2, 4, ... up to the number of hardware threads, and at least 8.
+std::vector<int64_t>
+thread_counts () {
+    std::vector<int64_t> counts;
+    const auto           limit = std::max<int64_t> (8, std::thread::hardware_concurrency());
+    for (int64_t t = 1; t <= limit; t *= 2) {
+        counts.push_back (t);
+    }
+    return counts;
+}
+
+// PageRank as it is usually first written: out-edges in linked lists,
+// each node pushing its score to its successors, one thread, fixed
+// iterations.
+std::vector<double>
+naive_page_rank (const std::vector<std::list<node_id>>& successors, const size_t iterations) {
+    const auto          n = successors.size();
+    std::vector<double> score (n, 1.0 / static_cast<double> (n));
+    for (size_t k = 0; k < iterations; ++k) {
+        std::vector<double> next (n, 0.0);
+        double              dangling = 0.0;
+        for (node_id id = 0; id < n; ++id) {
+            if (successors[id].empty()) {
+                dangling += score[id];
+                continue;
+            }
+            for (const auto tail : successors[id]) {
+                next[tail] += 0.85 * score[id] / static_cast<double> (successors[id].size());
+            }
+        }
+        for (auto& s : next) {
+            s += (0.15 + 0.85 * dangling) / static_cast<double> (n);
+        }
+        score.swap (next);
+    }
+    return score;
+}
+
+}  // namespace
+
+//
+// Breadth-first search from node 0 of a 256K-node graph.
+// The first argument is the shape, the second one the number of threads.
+//
+
+static void
+BM_ParallelBreadthFirst (benchmark::State& state) {
+    const auto  shape   = static_cast<int> (state.range (0));
+    const auto  threads = static_cast<size_t> (state.range (1));
+    const auto& frozen  = scaling_graph (shape).second;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize (parallel_breadth_first (frozen, 0, threads));
+    }
+
+    state.SetLabel (shape_name (shape));
+    state.SetItemsProcessed (state.iterations() * frozen.count_connections());
+}
+BENCHMARK (BM_ParallelBreadthFirst)
+    ->ArgsProduct ({{bench::random, bench::power_law}, thread_counts()})
+    ->Unit (benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Single-threaded top-down search over the mutable graph, as a baseline.
+static void
+BM_SequentialBreadthFirst (benchmark::State& state) {
+    const auto  shape = static_cast<int> (state.range (0));
+    const auto& gr    = scaling_graph (shape).first;
+
+    breadth_first_search<int> engine{true, gr.id_bound()};
+    for (auto _ : state) {
+        size_t count = 0;
+        gr.breadth_first (engine, 0, [&count] (const node<int>&) { ++count; });
+        benchmark::DoNotOptimize (count);
+    }
+
+    state.SetLabel (shape_name (shape));
+    state.SetItemsProcessed (state.iterations() * gr.count_connections());
+}
+BENCHMARK (BM_SequentialBreadthFirst)
+    ->Arg (bench::random)
+    ->Arg (bench::power_law)
+    ->Unit (benchmark::kMillisecond);
+
+//
+// Strongly connected components of a 256K-node graph.
+// The first argument is the shape, the second one the number of threads.
+//
+
+static void
+BM_ParallelStrongComponents (benchmark::State& state) {
+    const auto  shape   = static_cast<int> (state.range (0));
+    const auto  threads = static_cast<size_t> (state.range (1));
+    const auto& frozen  = scaling_graph (shape).second;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize (parallel_strongly_connected_components (frozen, threads));
+    }
+
+    state.SetLabel (shape_name (shape));
+    state.SetItemsProcessed (state.iterations() * frozen.count_connections());
+}
+BENCHMARK (BM_ParallelStrongComponents)
+    ->ArgsProduct ({{bench::random, bench::power_law, bench::chain}, thread_counts()})
+    ->Unit (benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Tarjan's algorithm over the frozen graph (second argument 0) and over the
+// mutable one (1), as a baseline.
+static void
+BM_SequentialStrongComponents (benchmark::State& state) {
+    const auto  shape  = static_cast<int> (state.range (0));
+    const auto& graphs = scaling_graph (shape);
+
+    for (auto _ : state) {
+        if (state.range (1) == 0) {
+            benchmark::DoNotOptimize (strongly_connected_components (graphs.second));
+        }
+        else {
+            benchmark::DoNotOptimize (graphs.first.strongly_connected_components());
+        }
+    }
+
+    state.SetLabel (
+        std::string{shape_name (shape)} + (state.range (1) == 0 ? "/frozen" : "/mutable")
+    );
+    state.SetItemsProcessed (state.iterations() * graphs.second.count_connections());
+}
+BENCHMARK (BM_SequentialStrongComponents)
+    ->ArgsProduct ({{bench::random, bench::power_law, bench::chain}, {0, 1}})
+    ->Unit (benchmark::kMillisecond);
+
+//
+// Twenty PageRank iterations over a 256K-node graph.  The first argument is
+// the shape, the second one the number of threads, and the third one the
+// precision: 0 for double, 1 for float.
+//
+
+static void
+BM_PageRank (benchmark::State& state) {
+    const auto  shape   = static_cast<int> (state.range (0));
+    const auto& frozen  = scaling_graph (shape).second;
+    const auto  options = page_rank_options{
+        .tolerance = 0, .max_iterations = 20, .threads = static_cast<size_t> (state.range (1))
+    };
+
+    for (auto _ : state) {
+        if (state.range (2) == 0) {
+            benchmark::DoNotOptimize (page_rank<double> (frozen, options));
+        }
+        else {
+            benchmark::DoNotOptimize (page_rank<float> (frozen, options));
+        }
+    }
+
+    state.SetLabel (
+        std::string{shape_name (shape)} + (state.range (2) == 0 ? "/double" : "/float")
+    );
+    state.SetItemsProcessed (state.iterations() * 20 * frozen.count_connections());
+}
+BENCHMARK (BM_PageRank)
+    ->ArgsProduct ({{bench::random, bench::power_law}, thread_counts(), {0, 1}})
+    ->Unit (benchmark::kMillisecond)
+    ->UseRealTime();
+
+// The naive reference over the same edges, as a baseline.
+static void
+BM_NaivePageRank (benchmark::State& state) {
+    const auto  shape  = static_cast<int> (state.range (0));
+    const auto& frozen = scaling_graph (shape).second;
+
+    std::vector<std::list<node_id>> successors (frozen.size());
+    for (node_id id = 0; id < frozen.size(); ++id) {
+        successors[id].assign (frozen.edges (id).begin(), frozen.edges (id).end());
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize (naive_page_rank (successors, 20));
+    }
+
+    state.SetLabel (shape_name (shape));
+    state.SetItemsProcessed (state.iterations() * 20 * frozen.count_connections());
+}
+BENCHMARK (BM_NaivePageRank)
+    ->Arg (bench::random)
+    ->Arg (bench::power_law)
+    ->Unit (benchmark::kMillisecond);
+
+//
+// Centrality of a 256K-node graph estimated from 16 sampled sources.  The
+// first argument is the shape, the second one the number of threads.
+//
+
+static void
+BM_SampledCentrality (benchmark::State& state) {
+    const auto  shape   = static_cast<int> (state.range (0));
+    const auto& frozen  = scaling_graph (shape).second;
+    const auto  options = centrality_options{
+        .samples = 16, .threads = static_cast<size_t> (state.range (1))
+    };
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize (centrality (frozen, options));
+    }
+
+    state.SetLabel (shape_name (shape));
+    state.SetItemsProcessed (state.iterations() * 16 * frozen.count_connections());
+}
+BENCHMARK (BM_SampledCentrality)
+    ->ArgsProduct ({{bench::random, bench::power_law}, thread_counts()})
+    ->Unit (benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,130 @@
+#include "generators.hpp"
+#include "shortest_path.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <utility>
+#include <vector>
+
+using namespace gpw::foundation;
+using namespace gpw::foundation::bench;
+
+namespace {
+
+// Grid sides: 64K nodes, and 1M nodes with 4M roads, the size of a large
+// metropolitan road network.
+const std::vector<int64_t> grid_sides{1 << 8, 1 << 10};
+
+// Building the largest network takes a while, so each one is built once.
+const csr_digraph<int, std::uint32_t>&
+road_network (const size_t side) {
+    static std::map<size_t, csr_digraph<int, std::uint32_t>> networks;
+
+    auto iter = networks.find (side);
+    if (iter == networks.end()) iter = networks.emplace (side, make_road_network (side)).first;
+    return iter->second;
+}
+
+// Ten times the Manhattan distance between two nodes of the grid.
+std::uint32_t
+grid_distance (const size_t side, const node_id from, const node_id to) {
+    const auto rows = std::abs (static_cast<long> (from / side) - static_cast<long> (to / side));
+    const auto cols = std::abs (static_cast<long> (from % side) - static_cast<long> (to % side));
+    return static_cast<std::uint32_t> (10 * (rows + cols));
+}
+
+}  // namespace
+
+//
+// Point-to-point queries between random nodes of a road network.
+// The argument is the side of the grid.
+//
+
+static void
+BM_Dijkstra (benchmark::State& state) {
+    const auto  side    = static_cast<size_t> (state.range (0));
+    const auto& roads   = road_network (side);
+    const auto  queries = make_queries (roads.size(), 16);
+
+    shortest_path_search<std::uint32_t> engine{roads.size()};
+    for (auto _ : state) {
+        std::uint64_t total = 0;
+        for (const auto& [source, target] : queries) {
+            total += *engine.dijkstra (
+                roads,
+                static_cast<node_id> (source),
+                static_cast<node_id> (target)
+            );
+        }
+        benchmark::DoNotOptimize (total);
+    }
+
+    state.SetItemsProcessed (state.iterations() * queries.size());
+}
+BENCHMARK (BM_Dijkstra)->ArgsProduct ({grid_sides})->Unit (benchmark::kMillisecond);
+
+// The same queries with a new engine each, which allocates and clears its
+// buffers every time.
+static void
+BM_DijkstraFreshEngine (benchmark::State& state) {
+    const auto  side    = static_cast<size_t> (state.range (0));
+    const auto& roads   = road_network (side);
+    const auto  queries = make_queries (roads.size(), 16);
+
+    for (auto _ : state) {
+        std::uint64_t total = 0;
+        for (const auto& [source, target] : queries) {
+            shortest_path_search<std::uint32_t> engine{roads.size()};
+            total += *engine.dijkstra (
+                roads,
+                static_cast<node_id> (source),
+                static_cast<node_id> (target)
+            );
+        }
+        benchmark::DoNotOptimize (total);
+    }
+
+    state.SetItemsProcessed (state.iterations() * queries.size());
+}
+BENCHMARK (BM_DijkstraFreshEngine)->ArgsProduct ({grid_sides})->Unit (benchmark::kMillisecond);
+
+static void
+BM_AStar (benchmark::State& state) {
+    const auto  side    = static_cast<size_t> (state.range (0));
+    const auto& roads   = road_network (side);
+    const auto  queries = make_queries (roads.size(), 16);
+
+    shortest_path_search<std::uint32_t> engine{roads.size()};
+    for (auto _ : state) {
+        std::uint64_t total = 0;
+        for (const auto& [source, target] : queries) {
+            const auto to = static_cast<node_id> (target);
+            total += *engine.a_star (roads, static_cast<node_id> (source), to, [&] (node_id id) {
+                return grid_distance (side, id, to);
+            });
+        }
+        benchmark::DoNotOptimize (total);
+    }
+
+    state.SetItemsProcessed (state.iterations() * queries.size());
+}
+BENCHMARK (BM_AStar)->ArgsProduct ({grid_sides})->Unit (benchmark::kMillisecond);
+
+// Distances from one node to every other.
+static void
+BM_DijkstraSingleSource (benchmark::State& state) {
+    const auto  side  = static_cast<size_t> (state.range (0));
+    const auto& roads = road_network (side);
+
+    shortest_path_search<std::uint32_t> engine{roads.size()};
+    for (auto _ : state) {
+        engine.dijkstra (roads, 0);
+        benchmark::DoNotOptimize (engine.distance (static_cast<node_id> (roads.size() - 1)));
+    }
+
+    state.SetItemsProcessed (state.iterations() * roads.size());
+}
+BENCHMARK (BM_DijkstraSingleSource)->ArgsProduct ({grid_sides})->Unit (benchmark::kMillisecond);
@@ -0,0 +1,278 @@
+#include "generators.hpp"
+#include "lca_index.hpp"
+#include "path_aggregate.hpp"
+#include "subtree_aggregate.hpp"
+#include "tree.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace gpw::foundation;
+using namespace gpw::foundation::bench;
+
+namespace {
+
+const std::vector<int64_t> tree_sizes{1 << 10, 1 << 14, 1 << 17};
+const std::vector<int64_t> tree_shapes{bench::random, bench::power_law, bench::chain};
+
+// Random nodes of an `n`-node tree, used as search targets.
+std::vector<size_t>
+make_targets (const size_t n, const size_t count) {
+    std::mt19937                          gen{9};
+    std::uniform_int_distribution<size_t> dist{0, n - 1};
+
+    std::vector<size_t> targets (count);
+    for (auto& target : targets) {
+        target = dist (gen);
+    }
+    return targets;
+}
+
+}  // namespace
+
+//
+// Core operations over random, power-law and chain trees.
+// The first argument is the number of nodes, the second one the shape.
+//
+
+static void
+BM_AppendNode (benchmark::State& state) {
+    const auto n       = static_cast<size_t> (state.range (0));
+    const auto labels  = make_labels (n);
+    const auto parents = make_parents (static_cast<int> (state.range (1)), n);
+
+    for (auto _ : state) {
+        tree<int> tr{labels[0]};
+        for (size_t i = 1; i < n; ++i) {
+            tr.append_node (labels[parents[i]], labels[i]);
+        }
+        benchmark::DoNotOptimize (tr.size());
+    }
+
+    state.SetLabel (shape_name (static_cast<int> (state.range (1))));
+    state.SetItemsProcessed (state.iterations() * (n - 1));
+}
+BENCHMARK (BM_AppendNode)
+    ->ArgsProduct ({{1 << 10, 1 << 14, 1 << 17}, tree_shapes})
+    ->Unit (benchmark::kMillisecond);
+
+static void
+BM_TreePath (benchmark::State& state) {
+    const auto n       = static_cast<size_t> (state.range (0));
+    const auto labels  = make_labels (n);
+    const auto tr      = make_tree (labels, make_parents (static_cast<int> (state.range (1)), n));
+    const auto targets = make_targets (n, 16);
+
+    for (auto _ : state) {
+        size_t length = 0;
+        for (const auto target : targets) {
+            length += tr->path (labels[target]).size();
+        }
+        benchmark::DoNotOptimize (length);
+    }
+
+    state.SetLabel (shape_name (static_cast<int> (state.range (1))));
+    state.SetItemsProcessed (state.iterations() * targets.size());
+}
+BENCHMARK (BM_TreePath)->ArgsProduct ({tree_sizes, tree_shapes});
+
+static void
+BM_TreeIsDescendent (benchmark::State& state) {
+    const auto n       = static_cast<size_t> (state.range (0));
+    const auto labels  = make_labels (n);
+    const auto tr      = make_tree (labels, make_parents (static_cast<int> (state.range (1)), n));
+    const auto targets = make_targets (n, 32);
+
+    for (auto _ : state) {
+        size_t hits = 0;
+        for (size_t i = 1; i < targets.size(); ++i) {
+            hits += tr->is_descendent_of (labels[targets[i]], labels[targets[i - 1]]);
+        }
+        benchmark::DoNotOptimize (hits);
+    }
+
+    state.SetLabel (shape_name (static_cast<int> (state.range (1))));
+    state.SetItemsProcessed (state.iterations() * (targets.size() - 1));
+}
+BENCHMARK (BM_TreeIsDescendent)->ArgsProduct ({tree_sizes, tree_shapes});
+
+static void
+BM_TreeDescription (benchmark::State& state) {
+    const auto n      = static_cast<size_t> (state.range (0));
+    const auto labels = make_labels (n);
+    const auto tr     = make_tree (labels, make_parents (static_cast<int> (state.range (1)), n));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize (tr->description());
+    }
+
+    state.SetLabel (shape_name (static_cast<int> (state.range (1))));
+    state.SetItemsProcessed (state.iterations() * n);
+}
+BENCHMARK (BM_TreeDescription)->ArgsProduct ({{1 << 8, 1 << 10, 1 << 12}, tree_shapes});
+
+// Path to the last node, the deepest one of a chain, on wide (power-law) and
+// deep (chain) trees.
+static void
+BM_TreeDeepestPath (benchmark::State& state) {
+    const auto n      = static_cast<size_t> (state.range (0));
+    const auto labels = make_labels (n);
+    const auto tr     = make_tree (labels, make_parents (static_cast<int> (state.range (1)), n));
+    const auto dst    = static_cast<node_id> (n - 1);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize (tr->path (dst));
+    }
+
+    state.SetLabel (shape_name (static_cast<int> (state.range (1))));
+    state.SetComplexityN (state.range (0));
+}
+BENCHMARK (BM_TreeDeepestPath)
+    ->ArgsProduct ({{1 << 12, 1 << 15, 1 << 18, 1 << 20}, {bench::power_law}})
+    ->Complexity (benchmark::oN);
+BENCHMARK (BM_TreeDeepestPath)
+    ->ArgsProduct ({{1 << 12, 1 << 15, 1 << 18, 1 << 20}, {bench::chain}})
+    ->Complexity (benchmark::oN);
+
+//
+// Targeted benchmarks
+//
+
+// Builds a tree in which every node `i` is a child of node `i / 4`.
+static void
+BM_TreeConstruction (benchmark::State& state) {
+    const auto n      = static_cast<size_t> (state.range (0));
+    const auto labels = make_labels (n);
+
+    for (auto _ : state) {
+        tree<int> tr{labels[0]};
+        for (size_t i = 1; i < n; ++i) {
+            tr.append_node (labels[i / 4], labels[i]);
+        }
+        benchmark::DoNotOptimize (tr.size());
+    }
+
+    state.SetComplexityN (state.range (0));
+}
+BENCHMARK (BM_TreeConstruction)
+    ->RangeMultiplier (4)
+    ->Range (1 << 10, 1 << 18)
+    ->Unit (benchmark::kMillisecond)
+    ->Complexity (benchmark::oN);
+
+// Building an LCA index, then querying it: the same ancestry questions as
+// BM_TreeIsDescendent, plus lowest common ancestors.
+static void
+BM_LcaIndexBuild (benchmark::State& state) {
+    const auto n      = static_cast<size_t> (state.range (0));
+    const auto labels = make_labels (n);
+    const auto tr     = make_tree (labels, make_parents (static_cast<int> (state.range (1)), n));
+
+    for (auto _ : state) {
+        const lca_index index{*tr};
+        benchmark::DoNotOptimize (index.size());
+    }
+
+    state.SetLabel (shape_name (static_cast<int> (state.range (1))));
+    state.SetItemsProcessed (state.iterations() * n);
+}
+BENCHMARK (BM_LcaIndexBuild)->ArgsProduct ({tree_sizes, tree_shapes});
+
+static void
+BM_LcaIndexQuery (benchmark::State& state) {
+    const auto n       = static_cast<size_t> (state.range (0));
+    const auto labels  = make_labels (n);
+    const auto tr      = make_tree (labels, make_parents (static_cast<int> (state.range (1)), n));
+    const auto targets = make_targets (n, 1024);
+
+    const lca_index index{*tr};
+    for (auto _ : state) {
+        size_t hits = 0;
+        for (size_t i = 1; i < targets.size(); ++i) {
+            const auto a = static_cast<node_id> (targets[i]);
+            const auto b = static_cast<node_id> (targets[i - 1]);
+            hits += index.is_descendent_of (a, b);
+            hits += index.lowest_common_ancestor (a, b);
+        }
+        benchmark::DoNotOptimize (hits);
+    }
+
+    state.SetLabel (shape_name (static_cast<int> (state.range (1))));
+    state.SetItemsProcessed (state.iterations() * (targets.size() - 1));
+}
+BENCHMARK (BM_LcaIndexQuery)->ArgsProduct ({tree_sizes, tree_shapes});
+
+// Subtree sums of random nodes, interleaved with data updates.  The third
+// argument selects the method: 0 walks the subtree on every query, and 1
+// keeps a subtree_aggregate up to date.
+static void
+BM_SubtreeSum (benchmark::State& state) {
+    const auto n       = static_cast<size_t> (state.range (0));
+    const auto labels  = make_labels (n);
+    const auto tr      = make_tree (labels, make_parents (static_cast<int> (state.range (1)), n));
+    const auto targets = make_targets (n, 64);
+
+    subtree_aggregate<int> sums{*tr};
+    for (auto _ : state) {
+        long total = 0;
+        for (size_t i = 0; i < targets.size(); ++i) {
+            const auto id = static_cast<node_id> (targets[i]);
+            if (state.range (2) == 0) {
+                tr->set_data (id, static_cast<int> (i));
+                tr->depth_first (id, [&total] (const node<int>& n) { total += *n.data(); });
+            }
+            else {
+                sums.set_data (id, static_cast<int> (i));
+                total += sums.value (id);
+            }
+        }
+        benchmark::DoNotOptimize (total);
+    }
+
+    state.SetLabel (
+        std::string{shape_name (static_cast<int> (state.range (1)))}
+        + (state.range (2) == 0 ? "/walk" : "/aggregate")
+    );
+    state.SetItemsProcessed (state.iterations() * targets.size());
+}
+BENCHMARK (BM_SubtreeSum)->ArgsProduct ({tree_sizes, tree_shapes, {0, 1}});
+
+// Sums along the root paths of random nodes, interleaved with data updates.
+// The third argument selects the method: 0 materializes the labels of the
+// path, as callers of `tree::path` did, and 1 keeps a path_aggregate.
+static void
+BM_RootPathSum (benchmark::State& state) {
+    const auto n       = static_cast<size_t> (state.range (0));
+    const auto labels  = make_labels (n);
+    const auto tr      = make_tree (labels, make_parents (static_cast<int> (state.range (1)), n));
+    const auto targets = make_targets (n, 64);
+
+    path_aggregate<int> sums{*tr};
+    for (auto _ : state) {
+        long total = 0;
+        for (size_t i = 0; i < targets.size(); ++i) {
+            const auto id = static_cast<node_id> (targets[i]);
+            if (state.range (2) == 0) {
+                tr->set_data (id, static_cast<int> (i));
+                for (const auto& label : tr->path (labels[targets[i]])) {
+                    total += *tr->data (label);
+                }
+            }
+            else {
+                sums.set_data (id, static_cast<int> (i));
+                total += sums.value (id);
+            }
+        }
+        benchmark::DoNotOptimize (total);
+    }
+
+    state.SetLabel (
+        std::string{shape_name (static_cast<int> (state.range (1)))}
+        + (state.range (2) == 0 ? "/labels" : "/aggregate")
+    );
+    state.SetItemsProcessed (state.iterations() * targets.size());
+}
+BENCHMARK (BM_RootPathSum)->ArgsProduct ({tree_sizes, tree_shapes, {0, 1}});
@@ -0,0 +1,387 @@
+//
+// adjacency.hpp
+//
+// Contiguous Edge Storage of a Node
+//
+
+#ifndef __GPW_FOUNDATION_ADJACENCY__
+#define __GPW_FOUNDATION_ADJACENCY__
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <type_traits>
+#include <unordered_map>
+
+namespace gpw::foundation {
+
+namespace detail {
+
+// Weights of the entries of an `adjacency`, kept in step with the entries.
+// They live in `inline_values` while the entries are inline, and in `values`
+// otherwise.
+template <typename W, size_t N> struct edge_weights {
+    W  inline_values[N]{};
+    W* values = nullptr;
+};
+
+struct no_edge_weights {};
+
+}  // namespace detail
+
+/*******************************************************************************
+ *
+ * @class adjacency
+ *
+ */
+template <typename P, typename W = void, size_t N = 4> class adjacency {
+    static_assert (std::is_trivially_copyable_v<P>, "adjacency stores plain handles or pointers");
+
+public:
+    // Whether each entry carries a weight of type `W`.
+    static constexpr bool weighted = !std::is_void_v<W>;
+
+    // `W`, or a placeholder that is never stored when the entries carry no
+    // weight.
+    using weight_type = std::conditional_t<weighted, W, int>;
+
+private:
+    static_assert (std::is_trivially_copyable_v<weight_type>, "edge weights are plain values");
+
+    using weight_storage = std::
+        conditional_t<weighted, detail::edge_weights<weight_type, N>, detail::no_edge_weights>;
+
+    // Up to `N` entries live in `_inline`, so that low-degree nodes need no
+    // allocation at all.  Beyond that, the entries move to a buffer obtained
+    // from `_resource`.  The entries are kept contiguous in both cases;
+    // `_data` points to whichever buffer is in use.
+    P                                    _inline[N];
+    P*                                   _data     = _inline;
+    std::uint32_t                        _size     = 0;
+    std::uint32_t                        _capacity = N;
+    std::pmr::memory_resource*           _resource;
+    [[no_unique_address]] weight_storage _weights;
+
+    // Once a node has more than `index_threshold` entries, a linear search is
+    // no longer cheap.  From then on, the position of each entry is also kept
+    // in a hash table.
+    using position_index = std::pmr::unordered_map<P, std::uint32_t>;
+
+    position_index* _positions = nullptr;
+
+public:
+    static constexpr size_t index_threshold = 32;
+
+    using value_type     = P;
+    using const_iterator = const P*;
+    using iterator       = const_iterator;
+
+    // Every allocation of this adjacency goes through `resource`.
+    explicit adjacency (std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : _resource{resource} {}
+
+    adjacency (const adjacency& other)
+        : _resource{other._resource} {
+        reserve (other._size);
+        std::copy (other.begin(), other.end(), _data);
+        if constexpr (weighted) {
+            std::copy (other.weights(), other.weights() + other._size, weights());
+        }
+        _size = other._size;
+        if (other._positions) build_index();
+    }
+
+    adjacency (adjacency&& other) noexcept
+        : _resource{other._resource} {
+        steal (other);
+    }
+
+    ~adjacency () { release(); }
+
+    adjacency&
+    operator= (const adjacency& other) {
+        if (this != &other) *this = adjacency{other};
+        return *this;
+    }
+
+    // Takes over the entries and the memory resource of `other`.
+    adjacency&
+    operator= (adjacency&& other) noexcept {
+        if (this != &other) {
+            release();
+            _resource = other._resource;
+            steal (other);
+        }
+        return *this;
+    }
+
+    const_iterator
+    begin () const {
+        return _data;
+    }
+
+    const_iterator
+    end () const {
+        return _data + _size;
+    }
+
+    const_iterator
+    cbegin () const {
+        return begin();
+    }
+
+    const_iterator
+    cend () const {
+        return end();
+    }
+
+    size_t
+    size () const {
+        return _size;
+    }
+
+    bool
+    empty () const {
+        return _size == 0;
+    }
+
+    const P&
+    operator[] (const size_t i) const {
+        return _data[i];
+    }
+
+    // Weight of the `i`-th entry.
+    const weight_type&
+    weight (const size_t i) const
+        requires weighted
+    {
+        return weights()[i];
+    }
+
+    bool
+    contains (const P& value) const {
+        return position (value) != _size;
+    }
+
+    // Index of `value` among the entries, or `size()` if it is absent.
+    size_t
+    position (const P& value) const {
+        if (_positions) {
+            auto iter = _positions->find (value);
+            return iter == _positions->end() ? _size : iter->second;
+        }
+
+        return std::find (begin(), end(), value) - begin();
+    }
+
+    // Appends `value` unless it is already present.
+    bool
+    insert (const P& value) {
+        if (contains (value)) return false;
+
+        append (value);
+        return true;
+    }
+
+    // Appends `value` with `weight`, or only updates the weight if `value` is
+    // already present.  Returns whether `value` was appended.
+    bool
+    insert (const P& value, const weight_type& weight)
+        requires weighted
+    {
+        if (const auto pos = position (value); pos != _size) {
+            weights()[pos] = weight;
+            return false;
+        }
+
+        append (value);
+        weights()[_size - 1] = weight;
+        return true;
+    }
+
+    // Removes `value` by moving the last entry into its place.
+    // The order of the remaining entries is therefore not preserved.
+    bool
+    erase (const P& value) {
+        size_t pos = 0;
+        if (_positions) {
+            auto iter = _positions->find (value);
+            if (iter == _positions->end()) return false;
+
+            pos = iter->second;
+            _positions->erase (iter);
+        }
+        else {
+            auto iter = std::find (begin(), end(), value);
+            if (iter == end()) return false;
+
+            pos = iter - begin();
+        }
+
+        erase_at (pos);
+        return true;
+    }
+
+    template <typename Pred>
+    size_t
+    erase_if (Pred pred) {
+        size_t count = 0;
+        for (size_t pos = 0; pos < _size;) {
+            if (pred (_data[pos])) {
+                if (_positions) _positions->erase (_data[pos]);
+                erase_at (pos);
+                ++count;
+            }
+            else {
+                ++pos;
+            }
+        }
+        return count;
+    }
+
+    // Replaces the entries with [first, last), which must be distinct.
+    // The storage is sized once for all of them.  Weights, if any, are
+    // value-initialized.
+    template <typename InputIt>
+    void
+    assign (InputIt first, InputIt last) {
+        clear();
+        reserve (static_cast<size_t> (std::distance (first, last)));
+        for (; first != last; ++first) {
+            _data[_size++] = *first;
+        }
+        if constexpr (weighted) std::fill (weights(), weights() + _size, weight_type{});
+        if (_size > index_threshold) build_index();
+    }
+
+    void
+    reserve (const size_t capacity) {
+        if (capacity <= _capacity) return;
+
+        auto buffer = allocate<P> (capacity);
+        std::copy (begin(), end(), buffer);
+        if constexpr (weighted) {
+            auto values = allocate<weight_type> (capacity);
+            std::copy (weights(), weights() + _size, values);
+            if (_data != _inline) deallocate (_weights.values, _capacity);
+            _weights.values = values;
+        }
+
+        if (_data != _inline) deallocate (_data, _capacity);
+        _data     = buffer;
+        _capacity = static_cast<std::uint32_t> (capacity);
+    }
+
+    void
+    clear () {
+        release();
+        _data     = _inline;
+        _size     = 0;
+        _capacity = N;
+    }
+
+private:
+    weight_type*
+    weights ()
+        requires weighted
+    {
+        return _data == _inline ? _weights.inline_values : _weights.values;
+    }
+
+    const weight_type*
+    weights () const
+        requires weighted
+    {
+        return _data == _inline ? _weights.inline_values : _weights.values;
+    }
+
+    template <typename U>
+    U*
+    allocate (const size_t count) {
+        return static_cast<U*> (_resource->allocate (count * sizeof (U), alignof (U)));
+    }
+
+    template <typename U>
+    void
+    deallocate (U* buffer, const size_t count) {
+        _resource->deallocate (buffer, count * sizeof (U), alignof (U));
+    }
+
+    void
+    append (const P& value) {
+        if (_size == _capacity) reserve (size_t{_capacity} * 2);
+
+        _data[_size] = value;
+        if (_positions) _positions->emplace (value, _size);
+        ++_size;
+
+        if (!_positions && _size > index_threshold) build_index();
+    }
+
+    void
+    erase_at (const size_t pos) {
+        const auto last = _size - 1;
+        if (pos != last) {
+            _data[pos] = _data[last];
+            if constexpr (weighted) weights()[pos] = weights()[last];
+            if (_positions) (*_positions)[_data[pos]] = static_cast<std::uint32_t> (pos);
+        }
+        _size = last;
+    }
+
+    void
+    build_index () {
+        std::pmr::polymorphic_allocator<> alloc{_resource};
+
+        _positions = alloc.new_object<position_index>();
+        _positions->reserve (size_t{_capacity});
+        for (std::uint32_t pos = 0; pos < _size; ++pos) {
+            _positions->emplace (_data[pos], pos);
+        }
+    }
+
+    void
+    release () {
+        if (_positions) {
+            std::pmr::polymorphic_allocator<> alloc{_resource};
+            alloc.delete_object (_positions);
+            _positions = nullptr;
+        }
+        if (_data != _inline) {
+            deallocate (_data, _capacity);
+            if constexpr (weighted) deallocate (_weights.values, _capacity);
+        }
+    }
+
+    // `other` must use the same memory resource as this adjacency.
+    void
+    steal (adjacency& other) {
+        _size      = other._size;
+        _capacity  = other._capacity;
+        _positions = other._positions;
+        if (other._data != other._inline) {
+            _data = other._data;
+            if constexpr (weighted) _weights.values = other._weights.values;
+        }
+        else {
+            std::copy (other.begin(), other.end(), _inline);
+            if constexpr (weighted) {
+                std::copy (
+                    other._weights.inline_values,
+                    other._weights.inline_values + other._size,
+                    _weights.inline_values
+                );
+            }
+            _data = _inline;
+        }
+        other._data      = other._inline;
+        other._size      = 0;
+        other._capacity  = N;
+        other._positions = nullptr;
+    }
+};
+
+}  // namespace gpw::foundation
+
+#endif
@@ -0,0 +1,205 @@
+//
+// centrality.hpp
+//
+// Betweenness, Closeness and Harmonic Centrality over a Frozen Graph
+//
+
+#ifndef __GPW_FOUNDATION_CENTRALITY__
+#define __GPW_FOUNDATION_CENTRALITY__
+
+#include "csr_digraph.hpp"
+#include "node.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace gpw::foundation {
+
+struct centrality_options {
+    // Number of source nodes to search from, drawn at random without
+    // repetition, for graphs too large to search from every node.  The
+    // scores are then scaled up by `size / samples`, which makes them
+    // unbiased estimates of the exact ones.  0, or at least the size of the
+    // graph, searches from every node.
+    size_t        samples = 0;
+    std::uint64_t seed    = 1;
+
+    // 0 means as many threads as the hardware runs concurrently.
+    size_t threads = 0;
+};
+
+// Centrality of every node, indexed by node id.  Distances count edges, and
+// are taken towards the scored node:
+// - betweenness: the sum, over the pairs of other nodes `s` and `t`, of the
+//   share of the shortest paths from `s` to `t` that go through the node;
+// - closeness: the number of nodes that reach the node over the sum of
+//   their distances to it, times the share of the other nodes they make up
+//   (Wasserman and Faust), so that a node reached by few nodes does not
+//   score high; 0 if no node reaches it;
+// - harmonic: the sum of the inverse distances from every other node.
+struct centrality_scores {
+    std::vector<double> betweenness;
+    std::vector<double> closeness;
+    std::vector<double> harmonic;
+
+    // Number of nodes searched from.
+    size_t sources = 0;
+};
+
+namespace detail {
+
+// Buffers of one thread, sized to the graph once and reused for every
+// source.  A search resets only the entries of the nodes it reached.
+struct brandes_workspace {
+    static constexpr std::uint32_t unreached = std::numeric_limits<std::uint32_t>::max();
+
+    // Per search: distance from the source, number of shortest paths from
+    // it, dependency of the source on the node, and the nodes reached, in
+    // the order they were reached.
+    std::vector<std::uint32_t> distance;
+    std::vector<double>        paths;
+    std::vector<double>        dependency;
+    std::vector<node_id>       order;
+
+    // Sums over the sources searched by this thread.
+    std::vector<double>        betweenness;
+    std::vector<double>        harmonic;
+    std::vector<std::uint64_t> total_distance;
+    std::vector<std::uint32_t> reached_by;
+
+    explicit brandes_workspace (const size_t n)
+        : distance (n, unreached)
+        , paths (n, 0.0)
+        , dependency (n, 0.0)
+        , betweenness (n, 0.0)
+        , harmonic (n, 0.0)
+        , total_distance (n, 0)
+        , reached_by (n, 0) {
+        order.reserve (n);
+    }
+
+    // One source of Brandes' algorithm ("A Faster Algorithm for Betweenness
+    // Centrality", 2001): a breadth-first search counts the shortest paths
+    // to every node, and the nodes are then taken back in reverse order,
+    // each passing its dependency on to its predecessors on shortest paths.
+    // The predecessors are found again among the incoming edges rather than
+    // recorded, which keeps the memory of a search linear in the nodes.
+    template <typename T, typename W>
+    void
+    search (const csr_digraph<T, W>& gr, const node_id source) {
+        order.clear();
+        order.push_back (source);
+        distance[source] = 0;
+        paths[source]    = 1.0;
+
+        for (size_t head = 0; head < order.size(); ++head) {
+            const auto id   = order[head];
+            const auto next = distance[id] + 1;
+            for (const auto tail : gr.edges (id)) {
+                if (distance[tail] == unreached) {
+                    distance[tail] = next;
+                    order.push_back (tail);
+                }
+                if (distance[tail] == next) paths[tail] += paths[id];
+            }
+        }
+
+        for (size_t i = order.size(); i-- > 1;) {
+            const auto id      = order[i];
+            const auto through = (1.0 + dependency[id]) / paths[id];
+            for (const auto head : gr.in_edges (id)) {
+                if (distance[head] + 1 == distance[id]) dependency[head] += paths[head] * through;
+            }
+
+            betweenness[id] += dependency[id];
+            harmonic[id] += 1.0 / distance[id];
+            total_distance[id] += distance[id];
+            ++reached_by[id];
+        }
+
+        for (const auto id : order) {
+            distance[id]   = unreached;
+            paths[id]      = 0.0;
+            dependency[id] = 0.0;
+        }
+    }
+};
+
+}  // namespace detail
+
+// Betweenness, closeness and harmonic centrality of every node of a frozen
+// graph (see `centrality_scores`), from one breadth-first search per source.
+// The sources are split across `opts.threads` threads, each with its own
+// buffers and sums, which are merged once the thread is done; memory is
+// thus linear in the nodes per thread, whatever the number of sources.
+template <typename T, typename W>
+centrality_scores
+centrality (const csr_digraph<T, W>& gr, const centrality_options& opts = {}) {
+    const auto        n = gr.size();
+    centrality_scores result{
+        std::vector<double> (n, 0.0), std::vector<double> (n, 0.0), std::vector<double> (n, 0.0)
+    };
+    if (n == 0) return result;
+
+    std::vector<node_id> sources (n);
+    std::iota (sources.begin(), sources.end(), node_id{0});
+    if (opts.samples != 0 && opts.samples < n) {
+        // The first `samples` steps of a Fisher-Yates shuffle.
+        std::mt19937_64 gen{opts.seed};
+        for (size_t i = 0; i < opts.samples; ++i) {
+            std::uniform_int_distribution<size_t> pick{i, n - 1};
+            std::swap (sources[i], sources[pick (gen)]);
+        }
+        sources.resize (opts.samples);
+    }
+    result.sources = sources.size();
+
+    std::vector<std::uint64_t> total_distance (n, 0);
+    std::vector<std::uint64_t> reached_by (n, 0);
+    std::mutex                 merge_lock;
+    parallel_for (
+        0,
+        sources.size(),
+        [&] (const size_t lo, const size_t hi) {
+            detail::brandes_workspace local{n};
+            for (size_t i = lo; i < hi; ++i) {
+                local.search (gr, sources[i]);
+            }
+
+            std::scoped_lock lock{merge_lock};
+            for (node_id id = 0; id < n; ++id) {
+                result.betweenness[id] += local.betweenness[id];
+                result.harmonic[id] += local.harmonic[id];
+                total_distance[id] += local.total_distance[id];
+                reached_by[id] += local.reached_by[id];
+            }
+        },
+        opts.threads
+    );
+
+    const auto scale = static_cast<double> (n) / static_cast<double> (sources.size());
+    for (node_id id = 0; id < n; ++id) {
+        result.betweenness[id] *= scale;
+        result.harmonic[id] *= scale;
+        if (total_distance[id] == 0) continue;
+
+        // With sampled sources, both sums scale alike, and only the share
+        // of the nodes reaching this one needs scaling up.
+        const auto reached   = static_cast<double> (reached_by[id]);
+        result.closeness[id] = reached / static_cast<double> (total_distance[id])
+                               * std::min (1.0, scale * reached / static_cast<double> (n - 1));
+    }
+
+    return result;
+}
+
+}  // namespace gpw::foundation
+
+#endif
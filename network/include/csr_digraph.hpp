@@ -0,0 +1,220 @@
+//
+// csr_digraph.hpp
+//
+// Frozen Directional Graph in Compressed Sparse Row Form
+//
+
+#ifndef __GPW_FOUNDATION_CSR_DIGRAPH__
+#define __GPW_FOUNDATION_CSR_DIGRAPH__
+
+#include "adjacency.hpp"
+#include "label_pool.hpp"
+#include "node.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace gpw::foundation {
+
+/*******************************************************************************
+ *
+ * @class csr_digraph
+ *
+ */
+template <typename T, typename W = void> class csr_digraph {
+public:
+    // Whether each edge carries a weight of type `W`.
+    static constexpr bool weighted = !std::is_void_v<W>;
+
+    // `W`, or a placeholder that is never stored for an unweighted graph.
+    using weight_type = std::conditional_t<weighted, W, int>;
+
+    // The weights of all edges, in the order of `targets`, or nothing for an
+    // unweighted graph.
+    using weight_vector =
+        std::conditional_t<weighted, std::vector<weight_type>, detail::no_edge_weights>;
+
+private:
+    // The nodes are numbered densely from 0 to `size() - 1`.
+    // The targets of the edges leaving node `i` are stored, sorted, in
+    // `_targets[_offsets[i]]` .. `_targets[_offsets[i + 1] - 1]`, and the
+    // weights of those edges at the same positions of `_weights`.
+    // The data of node `i` is `_data[i]`, and its label is the symbol `i` of
+    // `_labels`.
+    std::vector<size_t>                 _offsets;
+    std::vector<node_id>                _targets;
+    [[no_unique_address]] weight_vector _weights;
+    std::vector<T>                      _data;
+    label_pool                          _labels;
+
+    // The same edges grouped by tail: the heads of the edges entering node
+    // `i` are stored, sorted, in `_sources[_in_offsets[i]]` ..
+    // `_sources[_in_offsets[i + 1] - 1]`.
+    std::vector<size_t>  _in_offsets;
+    std::vector<node_id> _sources;
+
+public:
+    csr_digraph ()
+        : _offsets (1, 0)
+        , _in_offsets (1, 0) {}
+
+    // The labels must be distinct.  `offsets` must have `labels.size() + 1`
+    // elements, starting with 0, and every row of `targets` must be free of
+    // duplicates.  The rows are sorted here so that an edge can be found by
+    // binary search.  `weights` goes along with `targets`.  The incoming
+    // edges of every node are gathered as well.
+    csr_digraph (
+        const std::vector<std::string_view>& labels,
+        std::vector<T>                       data,
+        std::vector<size_t>                  offsets,
+        std::vector<node_id>                 targets,
+        weight_vector                        weights = {}
+    )
+        : _offsets{std::move (offsets)}
+        , _targets{std::move (targets)}
+        , _weights{std::move (weights)}
+        , _data{std::move (data)} {
+        _labels.reserve (labels.size());
+        for (node_id id = 0; id < labels.size(); ++id) {
+            _labels.intern (labels[id]);
+            sort_row (id);
+        }
+        gather_in_edges();
+    }
+
+    size_t
+    size () const {
+        return _data.size();
+    }
+
+    std::optional<node_id>
+    id (const std::string_view label) const {
+        return _labels.find (label);
+    }
+
+    std::string_view
+    label (const node_id id) const {
+        return _labels.view (id);
+    }
+
+    const T&
+    data (const node_id id) const {
+        return _data[id];
+    }
+
+    std::span<const node_id>
+    edges (const node_id id) const {
+        return {_targets.data() + _offsets[id], _offsets[id + 1] - _offsets[id]};
+    }
+
+    // Heads of the edges entering `id`, sorted.
+    std::span<const node_id>
+    in_edges (const node_id id) const {
+        return {_sources.data() + _in_offsets[id], _in_offsets[id + 1] - _in_offsets[id]};
+    }
+
+    size_t
+    in_degree (const node_id id) const {
+        return _in_offsets[id + 1] - _in_offsets[id];
+    }
+
+    // Weights of the edges leaving `id`, in the order of `edges (id)`.
+    std::span<const weight_type>
+    weights (const node_id id) const
+        requires weighted
+    {
+        return {_weights.data() + _offsets[id], _offsets[id + 1] - _offsets[id]};
+    }
+
+    // Weight of the edge from `head` to `tail`, if they are connected.
+    std::optional<weight_type>
+    weight (const node_id head, const node_id tail) const
+        requires weighted
+    {
+        auto row  = edges (head);
+        auto iter = std::lower_bound (row.begin(), row.end(), tail);
+        if (iter == row.end() || *iter != tail) return std::nullopt;
+
+        return _weights[_offsets[head] + (iter - row.begin())];
+    }
+
+    bool
+    is_connected (const node_id head, const node_id tail) const {
+        auto row = edges (head);
+        return std::binary_search (row.begin(), row.end(), tail);
+    }
+
+    bool
+    is_connected (const std::string_view hl, const std::string_view tl) const {
+        auto head = id (hl);
+        auto tail = id (tl);
+
+        if (!head || !tail) return false;
+
+        return is_connected (*head, *tail);
+    }
+
+    size_t
+    count_connections () const {
+        return _targets.size();
+    }
+
+    size_t
+    count_connections (const node_id id) const {
+        return _offsets[id + 1] - _offsets[id];
+    }
+
+private:
+    // Counting sort of the edges by tail.  Scanning the heads in order keeps
+    // each group sorted.
+    void
+    gather_in_edges () {
+        _in_offsets.assign (size() + 1, 0);
+        for (const auto tail : _targets) {
+            ++_in_offsets[tail + 1];
+        }
+        std::partial_sum (_in_offsets.begin(), _in_offsets.end(), _in_offsets.begin());
+
+        _sources.resize (_targets.size());
+        std::vector<size_t> cursor (_in_offsets.begin(), _in_offsets.end() - 1);
+        for (node_id head = 0; head < size(); ++head) {
+            for (const auto tail : edges (head)) {
+                _sources[cursor[tail]++] = head;
+            }
+        }
+    }
+
+    void
+    sort_row (const node_id id) {
+        const auto first = _offsets[id];
+        const auto last  = _offsets[id + 1];
+        if constexpr (!weighted) {
+            std::sort (_targets.begin() + first, _targets.begin() + last);
+        }
+        else {
+            if (std::is_sorted (_targets.begin() + first, _targets.begin() + last)) return;
+
+            std::vector<std::pair<node_id, weight_type>> row;
+            row.reserve (last - first);
+            for (auto i = first; i < last; ++i) {
+                row.emplace_back (_targets[i], _weights[i]);
+            }
+            std::sort (row.begin(), row.end(), [] (const auto& lhs, const auto& rhs) {
+                return lhs.first < rhs.first;
+            });
+            for (auto i = first; i < last; ++i) {
+                std::tie (_targets[i], _weights[i]) = row[i - first];
+            }
+        }
+    }
+};
+
+}  // namespace gpw::foundation
+
+#endif
@@ -0,0 +1,160 @@
+//
+// d_ary_heap.hpp
+//
+// Addressable Priority Queue of Node Ids
+//
+
+#ifndef __GPW_FOUNDATION_D_ARY_HEAP__
+#define __GPW_FOUNDATION_D_ARY_HEAP__
+
+#include "node.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace gpw::foundation {
+
+/*******************************************************************************
+ *
+ * @class d_ary_heap
+ *
+ */
+template <typename K, size_t D = 4> class d_ary_heap {
+    static_assert (D >= 2, "a heap node needs at least two children");
+
+public:
+    struct entry {
+        K       key;
+        node_id id;
+    };
+
+private:
+    // The smallest key is at `_entries[0]`, and the children of entry `i` are
+    // entries `D * i + 1` .. `D * i + D`.  A wide node makes the heap shallow
+    // and keeps the children of an entry on one or two cache lines, which
+    // pays off when, as in shortest-path searches, keys are decreased far
+    // more often than the minimum is removed.
+    std::vector<entry> _entries;
+
+    // Index in `_entries` of each node id, or `npos` if the id is not queued.
+    // Ids leave the heap only through `pop` and `clear`, which reset their
+    // positions, so the array never needs clearing as a whole.
+    static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+    std::vector<std::uint32_t>     _positions;
+
+public:
+    // `id_bound` sizes the positions up front; they grow as needed.
+    explicit d_ary_heap (const size_t id_bound = 0)
+        : _positions (id_bound, npos) {}
+
+    bool
+    empty () const {
+        return _entries.empty();
+    }
+
+    size_t
+    size () const {
+        return _entries.size();
+    }
+
+    bool
+    contains (const node_id id) const {
+        return id < _positions.size() && _positions[id] != npos;
+    }
+
+    // The entry with the smallest key.  The heap must not be empty.
+    const entry&
+    top () const {
+        return _entries.front();
+    }
+
+    // `id` must not be queued already.
+    void
+    push (const node_id id, const K& key) {
+        if (id >= _positions.size()) {
+            _positions.resize (std::max<size_t> (id + 1, _positions.size() * 2), npos);
+        }
+
+        _entries.push_back ({key, id});
+        sift_up (_entries.size() - 1);
+    }
+
+    // Lowers the key of a queued `id` to `key`, which must not be larger.
+    void
+    decrease (const node_id id, const K& key) {
+        const auto pos    = _positions[id];
+        _entries[pos].key = key;
+        sift_up (pos);
+    }
+
+    // Removes the entry with the smallest key.  The heap must not be empty.
+    void
+    pop () {
+        _positions[_entries.front().id] = npos;
+
+        const auto last = _entries.back();
+        _entries.pop_back();
+        if (!_entries.empty()) {
+            _entries.front() = last;
+            sift_down (0);
+        }
+    }
+
+    // Empties the heap in time proportional to its size.  The storage is
+    // kept for the next use.
+    void
+    clear () {
+        for (const auto& e : _entries) {
+            _positions[e.id] = npos;
+        }
+        _entries.clear();
+    }
+
+private:
+    void
+    place (const size_t pos, const entry& e) {
+        _entries[pos]    = e;
+        _positions[e.id] = static_cast<std::uint32_t> (pos);
+    }
+
+    void
+    sift_up (size_t pos) {
+        const auto e = _entries[pos];
+        while (pos > 0) {
+            const auto parent = (pos - 1) / D;
+            if (!(e.key < _entries[parent].key)) break;
+
+            place (pos, _entries[parent]);
+            pos = parent;
+        }
+        place (pos, e);
+    }
+
+    void
+    sift_down (size_t pos) {
+        const auto e = _entries[pos];
+        const auto n = _entries.size();
+        while (true) {
+            const auto first = D * pos + 1;
+            if (first >= n) break;
+
+            // Smallest of the children.
+            auto       best = first;
+            const auto last = std::min (first + D, n);
+            for (auto child = first + 1; child < last; ++child) {
+                if (_entries[child].key < _entries[best].key) best = child;
+            }
+            if (!(_entries[best].key < e.key)) break;
+
+            place (pos, _entries[best]);
+            pos = best;
+        }
+        place (pos, e);
+    }
+};
+
+}  // namespace gpw::foundation
+
+#endif
@@ -0,0 +1,102 @@
+//
+// dag_executor.hpp
+//
+// Running the Nodes of a Dependency Graph in Parallel
+//
+
+#ifndef __GPW_FOUNDATION_DAG_EXECUTOR__
+#define __GPW_FOUNDATION_DAG_EXECUTOR__
+
+#include "csr_digraph.hpp"
+#include "node.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace gpw::foundation {
+
+/*******************************************************************************
+ *
+ * @class dag_executor
+ *
+ */
+template <typename T, typename W = void> class dag_executor {
+    // An edge from `a` to `b` means that `b` depends on `a`: `b` runs once
+    // `a` and its other predecessors have returned.
+    const csr_digraph<T, W>* _graph;
+
+    // Nodes without predecessors, which start a run.
+    std::vector<node_id> _sources;
+
+    // Predecessors of each node that have not returned yet in the current
+    // run.  The one that brings a count to zero makes the node ready, so
+    // nodes are released without any lock.
+    std::unique_ptr<std::atomic<std::uint32_t>[]> _pending;
+
+public:
+    // `gr` must outlive the executor.  The graph is read only, so a frozen
+    // snapshot serves any number of runs.
+    explicit dag_executor (const csr_digraph<T, W>& gr)
+        : _graph{&gr}
+        , _pending{new std::atomic<std::uint32_t>[gr.size()]} {
+        for (node_id id = 0; id < gr.size(); ++id) {
+            if (gr.in_degree (id) == 0) _sources.push_back (id);
+        }
+    }
+
+    // Calls `work (id)` for every node, each once its predecessors have
+    // returned, across the threads of `pool`.  `work` must not throw.
+    // Returns false if some nodes did not run because they are on a cycle or
+    // depend on one.
+    template <typename F>
+    bool
+    run (work_stealing_pool& pool, F&& work) {
+        const auto& gr = *_graph;
+        for (node_id id = 0; id < gr.size(); ++id) {
+            _pending[id].store (
+                static_cast<std::uint32_t> (gr.in_degree (id)), std::memory_order_relaxed
+            );
+        }
+
+        pool.run (_sources, [&] (node_id id, work_stealing_pool::spawner& sp) {
+            // The first successor made ready runs next on this thread,
+            // without going through the queue; the others are queued for
+            // any thread to take.  A chain of nodes thus runs as a loop.
+            while (id != invalid_node) {
+                work (id);
+
+                auto next = invalid_node;
+                for (const auto tail : gr.edges (id)) {
+                    if (_pending[tail].fetch_sub (1, std::memory_order_acq_rel) != 1) continue;
+
+                    if (next == invalid_node) next = tail;
+                    else sp.spawn (tail);
+                }
+                id = next;
+            }
+        });
+
+        for (node_id id = 0; id < gr.size(); ++id) {
+            if (_pending[id].load (std::memory_order_relaxed) != 0) return false;
+        }
+        return true;
+    }
+
+    // Calls the data of every node, which must be callable, in dependency
+    // order.
+    bool
+    run (work_stealing_pool& pool)
+        requires std::invocable<const T&>
+    {
+        return run (pool, [this] (const node_id id) { _graph->data (id)(); });
+    }
+};
+
+}  // namespace gpw::foundation
+
+#endif
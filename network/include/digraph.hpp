@@ -7,11 +7,27 @@
 #ifndef __GPW_FOUNDATION_DIGRAPH__
 #define __GPW_FOUNDATION_DIGRAPH__
 
+#include "csr_digraph.hpp"
+#include "label_pool.hpp"
 #include "node.hpp"
+#include "object_pool.hpp"
+#include "parallel.hpp"
+#include "strong_components.hpp"
+#include "topological_sort.hpp"
+#include "traversal.hpp"
 
-#include <list>
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
 #include <numeric>
+#include <optional>
+#include <ranges>
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace gpw::foundation {
 
@@ -20,37 +36,117 @@ namespace gpw::foundation {
  * @class digraph
  *
  */
-template <typename T> class digraph {
+template <typename T, typename W = void> class digraph {
 private:
-    using node_ptr = node<T>*;
+    using node_ptr = node<T, W>*;
 
     // Because this graph is responsible for the resource management for all of
-    // its nodes, this class has a list of unique_ptrs of the nodes.
+    // its nodes, the nodes are created in `_node_pool`, and their edge
+    // buffers are allocated from `_edge_resource`.  Both hand out memory from
+    // large blocks and recycle what is freed, so that building a graph takes a
+    // handful of allocations and dropping it releases the blocks at once.
     // The connections between the nodes are saved using raw pointers, which
     // do not state the ownership between them.
     // Each node has pointers to other nodes connected to it.
-    std::list<std::unique_ptr<node<T>>> _nodes;
+    std::unique_ptr<std::pmr::unsynchronized_pool_resource> _edge_resource = make_edge_resource();
+    object_pool<node<T, W>> _node_pool;
+
+    // A node lives at the index given by its id.  The slot of a removed node
+    // is left empty and its id is kept in `_free_ids`, to be handed out again
+    // by a later `create_node`.
+    std::vector<node_ptr> _nodes;
+    std::vector<node_id>  _free_ids;
+
+    // Every label is stored once in `_labels`, and the nodes only view it.
+    // `_symbol_nodes` maps the symbol of a label to the id of its node (or
+    // `invalid_node`).  It is kept in sync by `create_node` and `remove_node`,
+    // so that finding a node (and rejecting duplicates) costs one hash lookup
+    // followed by integer compares.  The label of a removed node stays in the
+    // pool, and is reused if the label is created again.
+    label_pool           _labels;
+    std::vector<node_id> _symbol_nodes;
 
 public:
     digraph () {}
-    virtual ~digraph () {}
 
+    // The moved-from graph is left empty, with resources of its own.
+    digraph (digraph&& other)
+        : _edge_resource{std::exchange (other._edge_resource, make_edge_resource())}
+        , _node_pool{std::move (other._node_pool)}
+        , _nodes{std::exchange (other._nodes, {})}
+        , _free_ids{std::exchange (other._free_ids, {})}
+        , _labels{std::move (other._labels)}
+        , _symbol_nodes{std::exchange (other._symbol_nodes, {})} {}
+
+    digraph&
+    operator= (digraph&& other) {
+        if (this != &other) {
+            destroy_nodes();
+            _edge_resource = std::exchange (other._edge_resource, make_edge_resource());
+            _node_pool     = std::move (other._node_pool);
+            _nodes         = std::exchange (other._nodes, {});
+            _free_ids      = std::exchange (other._free_ids, {});
+            _labels        = std::move (other._labels);
+            _symbol_nodes  = std::exchange (other._symbol_nodes, {});
+        }
+        return *this;
+    }
+
+    virtual ~digraph () { destroy_nodes(); }
+
+    // Prepares the storage for `count` nodes in total.
     void
+    reserve (const size_t count) {
+        _nodes.reserve (count);
+        _symbol_nodes.reserve (count);
+        _labels.reserve (count);
+    }
+
+    // Returns the id of the new node, or of the existing node if the label
+    // is already in use.
+    node_id
     create_node (const std::string& label, const T& data = T()) {
-        // Ignore if the label already exists in the list of nodes.
-        if (node_with_label (label) != nullptr) return;
+        return emplace_node (label, data);
+    }
 
-        _nodes.emplace_back (std::make_unique<node<T>> (label, data));
+    // Moves `data` into the new node; it is left alone if the label is
+    // already in use.
+    node_id
+    create_node (const std::string& label, T&& data) {
+        return emplace_node (label, std::move (data));
+    }
+
+    void
+    remove_node (const node_id id) {
+        auto ptr = node_with_id (id);
+        if (ptr == nullptr) return;
+
+        // Remove all connections to and from this node.  Only its neighbors
+        // are visited.
+        ptr->isolate();
+
+        _symbol_nodes[*_labels.find (ptr->label())] = invalid_node;
+        _node_pool.destroy (ptr);
+        _nodes[id] = nullptr;
+        _free_ids.push_back (id);
     }
 
     void
     remove_node (const std::string& label) {
-        // Remove all connections to this node
-        for (auto& ptr : _nodes) {
-            ptr->disconnect (label);
-        }
+        auto ptr = node_with_label (label);
+        if (ptr == nullptr) return;
+
+        remove_node (ptr->id());
+    }
 
-        _nodes.remove_if ([&label] (auto& node) { return node->label() == label; });
+    void
+    connect_node (const node_id head, const node_id tail) {
+        auto head_ptr = node_with_id (head);
+        auto tail_ptr = node_with_id (tail);
+
+        if (head_ptr == nullptr || tail_ptr == nullptr) return;
+
+        head_ptr->connect (*tail_ptr);
     }
 
     void
@@ -63,6 +159,68 @@ public:
         head_ptr->connect (*tail_ptr);
     }
 
+    // Connects `head` to `tail` with an edge of the given weight, or only
+    // updates the weight if they are connected already.  The unweighted
+    // `connect_node` gives a new edge a value-initialized weight.
+    template <typename U = W>
+        requires (!std::is_void_v<U>)
+    void
+    connect_node (const node_id head, const node_id tail, const U& weight) {
+        auto head_ptr = node_with_id (head);
+        auto tail_ptr = node_with_id (tail);
+
+        if (head_ptr == nullptr || tail_ptr == nullptr) return;
+
+        head_ptr->connect (*tail_ptr, weight);
+    }
+
+    template <typename U = W>
+        requires (!std::is_void_v<U>)
+    void
+    connect_node (const std::string& hl, const std::string& tl, const U& weight) {
+        auto head_ptr = node_with_label (hl);
+        auto tail_ptr = node_with_label (tl);
+
+        if (head_ptr == nullptr || tail_ptr == nullptr) return;
+
+        head_ptr->connect (*tail_ptr, weight);
+    }
+
+    // Weight of the edge from `head` to `tail`, if they are connected.
+    template <typename U = W>
+        requires (!std::is_void_v<U>)
+    std::optional<U>
+    weight (const node_id head, const node_id tail) const {
+        auto head_ptr = node_with_id (head);
+        auto tail_ptr = node_with_id (tail);
+
+        if (head_ptr == nullptr || tail_ptr == nullptr) return std::nullopt;
+
+        return head_ptr->weight (*tail_ptr);
+    }
+
+    template <typename U = W>
+        requires (!std::is_void_v<U>)
+    std::optional<U>
+    weight (const std::string& hl, const std::string& tl) const {
+        auto head_ptr = node_with_label (hl);
+        auto tail_ptr = node_with_label (tl);
+
+        if (head_ptr == nullptr || tail_ptr == nullptr) return std::nullopt;
+
+        return head_ptr->weight (*tail_ptr);
+    }
+
+    bool
+    is_connected (const node_id head, const node_id tail) const {
+        auto head_ptr = node_with_id (head);
+        auto tail_ptr = node_with_id (tail);
+
+        if (head_ptr == nullptr || tail_ptr == nullptr) return false;
+
+        return head_ptr->is_connected (*tail_ptr);
+    }
+
     bool
     is_connected (const std::string& hl, const std::string& tl) const {
         auto head_ptr = node_with_label (hl);
@@ -73,8 +231,70 @@ public:
         return head_ptr->is_connected (*tail_ptr);
     }
 
+    size_t
+    in_degree (const node_id id) const {
+        auto ptr = node_with_id (id);
+        if (ptr == nullptr) return 0;
+
+        return ptr->in_degree();
+    }
+
+    size_t
+    in_degree (const std::string& label) const {
+        auto ptr = node_with_label (label);
+        if (ptr == nullptr) return 0;
+
+        return ptr->in_degree();
+    }
+
+    bool
+    contains (const node_id id) const {
+        return node_with_id (id) != nullptr;
+    }
+
+    std::optional<node_id>
+    id (const std::string& label) const {
+        auto ptr = node_with_label (label);
+        if (ptr == nullptr) return std::nullopt;
+
+        return ptr->id();
+    }
+
+    // Nothing if `id` is not in the graph.
+    std::optional<T>
+    data (const node_id id) const {
+        auto ptr = node_with_id (id);
+        if (ptr == nullptr) return std::nullopt;
+
+        return ptr->data();
+    }
+
+    std::optional<T>
+    data (const std::string& label) const {
+        auto ptr = node_with_label (label);
+        if (ptr == nullptr) return std::nullopt;
+
+        return ptr->data();
+    }
+
+    // Nothing if `id` is not in the graph, such as the id of a removed node.
+    std::optional<std::string_view>
+    label (const node_id id) const {
+        auto ptr = node_with_id (id);
+        if (ptr == nullptr) return std::nullopt;
+
+        return ptr->label();
+    }
+
     size_t
     size () const {
+        return _nodes.size() - _free_ids.size();
+    }
+
+    // Every id in use is smaller than this bound, so that it can size arrays
+    // indexed by node id.
+    size_t
+    id_bound () const {
         return _nodes.size();
     }
 
@@ -83,26 +303,451 @@ public:
         return std::accumulate (
             _nodes.cbegin(),
             _nodes.cend(),
+            size_t{0},
+            [] (const size_t& acc, const auto& node) {
+                return node ? node->count_connections() + acc : acc;
+            }
+        );
+    }
+
+    // Calls `discover (node)` of `visitor` in pre-order and `finish (node)` in
+    // post-order, for each node reachable from `start` (see
+    // `depth_first_search`).  Returns false if the visitor stopped the
+    // traversal or `start` is not in the graph.  Passing an `engine` reuses
+    // its storage across traversals.
+    template <typename Visitor>
+    bool
+    depth_first (depth_first_search<T, W>& engine, const node_id start, Visitor&& visitor) const {
+        auto start_ptr = node_with_id (start);
+        if (start_ptr == nullptr) return false;
+
+        return engine.run (*start_ptr, std::forward<Visitor> (visitor));
+    }
+
+    template <typename Visitor>
+    bool
+    depth_first (const node_id start, Visitor&& visitor) const {
+        depth_first_search<T, W> engine{true, id_bound()};
+        return depth_first (engine, start, std::forward<Visitor> (visitor));
+    }
+
+    // Calls `discover (node)` of `visitor` when a node is first reached,
+    // `examine_edge (head, tail)` for each edge followed, and `finish (node)`
+    // once all edges of a node are examined, in breadth-first order from
+    // `start` (see `breadth_first_search`).  Returns false if the visitor
+    // stopped the traversal or `start` is not in the graph.  Passing an
+    // `engine` reuses its storage across traversals.
+    template <typename Visitor>
+    bool
+    breadth_first (
+        breadth_first_search<T, W>& engine,
+        const node_id               start,
+        Visitor&&                   visitor
+    ) const {
+        auto start_ptr = node_with_id (start);
+        if (start_ptr == nullptr) return false;
+
+        return engine.run (*start_ptr, std::forward<Visitor> (visitor));
+    }
+
+    template <typename Visitor>
+    bool
+    breadth_first (const node_id start, Visitor&& visitor) const {
+        breadth_first_search<T, W> engine{true, id_bound()};
+        return breadth_first (engine, start, std::forward<Visitor> (visitor));
+    }
+
+    // Whether `tail` can be reached from `head` by following edges.  A node
+    // always reaches itself.  Passing an `engine` reuses its storage across
+    // queries, so that a query allocates nothing once it has warmed up.
+    bool
+    is_reachable (
+        breadth_first_search<T, W>& engine,
+        const node_id               head,
+        const node_id               tail
+    ) const {
+        auto head_ptr = node_with_id (head);
+        auto tail_ptr = node_with_id (tail);
+
+        if (head_ptr == nullptr || tail_ptr == nullptr) return false;
+
+        // The search stops only when it meets `tail`.
+        return !engine.run (*head_ptr, [tail_ptr] (const node<T, W>& n) {
+            return &n == tail_ptr ? visit::stop : visit::proceed;
+        });
+    }
+
+    bool
+    is_reachable (const node_id head, const node_id tail) const {
+        breadth_first_search<T, W> engine{true, id_bound()};
+        return is_reachable (engine, head, tail);
+    }
+
+    bool
+    is_reachable (const std::string& hl, const std::string& tl) const {
+        auto head_ptr = node_with_label (hl);
+        auto tail_ptr = node_with_label (tl);
+
+        if (head_ptr == nullptr || tail_ptr == nullptr) return false;
+
+        return is_reachable (head_ptr->id(), tail_ptr->id());
+    }
+
+    // Writes to `path` a path from `head` to `tail` with the fewest edges,
+    // both ends included.  Returns false, leaving `path` empty, if `tail`
+    // cannot be reached.  `parent` is scratch space indexed by id; it is only
+    // written for the nodes the search reaches, so that like `engine` it is
+    // reused across queries without being cleared.
+    bool
+    path (
+        breadth_first_search<T, W>& engine,
+        std::vector<node_id>&       parent,
+        const node_id               head,
+        const node_id               tail,
+        std::vector<node_id>&       path
+    ) const {
+        path.clear();
+
+        auto head_ptr = node_with_id (head);
+        auto tail_ptr = node_with_id (tail);
+
+        if (head_ptr == nullptr || tail_ptr == nullptr) return false;
+        if (head_ptr == tail_ptr) {
+            path.push_back (head);
+            return true;
+        }
+
+        // Each node records the node it was first reached from.
+        if (parent.size() < id_bound()) parent.resize (id_bound());
+        struct {
+            const breadth_first_search<T, W>& engine;
+            std::vector<node_id>&             parent;
+            const node<T, W>*                 dst;
+
+            visit
+            examine_edge (const node<T, W>& from, const node<T, W>& to) {
+                if (!engine.visited (to.id())) parent[to.id()] = from.id();
+                return &to == dst ? visit::stop : visit::proceed;
+            }
+        } visitor{engine, parent, tail_ptr};
+
+        if (engine.run (*head_ptr, visitor)) return false;
+
+        for (auto id = tail; id != head; id = parent[id]) {
+            path.push_back (id);
+        }
+        path.push_back (head);
+        std::reverse (path.begin(), path.end());
+        return true;
+    }
+
+    // A path from `head` to `tail` with the fewest edges, both ends included,
+    // or an empty path if `tail` cannot be reached.
+    std::vector<node_id>
+    path (const node_id head, const node_id tail) const {
+        breadth_first_search<T, W> engine{true, id_bound()};
+        std::vector<node_id>       parent;
+        std::vector<node_id>       result;
+        path (engine, parent, head, tail, result);
+        return result;
+    }
+
+    std::vector<std::string>
+    path (const std::string& hl, const std::string& tl) const {
+        auto head_ptr = node_with_label (hl);
+        auto tail_ptr = node_with_label (tl);
+
+        if (head_ptr == nullptr || tail_ptr == nullptr) return {};
+
+        std::vector<std::string> labels;
+        for (const auto id : path (head_ptr->id(), tail_ptr->id())) {
+            labels.emplace_back (_nodes[id]->label());
+        }
+        return labels;
+    }
+
+    // Strongly connected components, numbered in reverse topological order:
+    // an edge between two components goes from the higher number to the
+    // lower one.  The search keeps its own stack, so that graphs of any depth
+    // can be searched.
+    strong_components
+    strongly_connected_components () const {
+        return detail::tarjan (
+            _nodes.size(),
+            [this] (const node_id id) { return _nodes[id] != nullptr; },
+            [this] (const node_id id) { return _nodes[id]->count_connections(); },
+            [this] (const node_id id, const size_t i) { return _nodes[id]->edges()[i]->id(); }
+        );
+    }
+
+    // The graph of the components of `scc`, which partitions this graph:
+    // node `c` stands for component `c`, is labeled with its number, and
+    // holds the ids of its members as data.  It has an edge from `c` to `d`
+    // wherever a member of `c` has one to a member of `d`.  With the numbers
+    // given by `strongly_connected_components`, the graph is acyclic and its
+    // edges go from higher to lower ids.
+    digraph<std::vector<node_id>>
+    condensation (const strong_components& scc) const {
+        std::vector<std::vector<node_id>> members (scc.count);
+        for (const auto& ptr : _nodes) {
+            if (ptr) members[scc.component[ptr->id()]].push_back (ptr->id());
+        }
+
+        digraph<std::vector<node_id>> dag;
+        dag.reserve (scc.count);
+        for (size_t c = 0; c < scc.count; ++c) {
+            dag.create_node (std::to_string (c), std::move (members[c]));
+        }
+
+        for (const auto& ptr : _nodes) {
+            if (!ptr) continue;
+
+            const auto head = scc.component[ptr->id()];
+            for (const auto& tail_ptr : ptr->edges()) {
+                const auto tail = scc.component[tail_ptr->id()];
+                if (head != tail) dag.connect_node (head, tail);
+            }
+        }
+        return dag;
+    }
+
+    digraph<std::vector<node_id>>
+    condensation () const {
+        return condensation (strongly_connected_components());
+    }
+
+    // Nodes in dependency order, grouped into levels of independent nodes,
+    // or one cycle of the graph if it has any (see `topological_order`).
+    // The sort counts down copies of the in-degrees the nodes keep, so it
+    // visits every node and edge once.
+    topological_order
+    topological_sort () const {
+        return detail::kahn (
+            _nodes.size(),
+            [this] (const node_id id) { return _nodes[id] != nullptr; },
+            [this] (const node_id id) { return _nodes[id]->count_connections(); },
+            [this] (const node_id id, const size_t i) { return _nodes[id]->edges()[i]->id(); },
+            [this] (const node_id id) { return _nodes[id]->in_degree(); },
+            [this] (const node_id id, const size_t i) { return _nodes[id]->in_edges()[i]->id(); }
+        );
+    }
+
+    // Packs the current nodes and connections, with their weights, into a
+    // read-only snapshot.  The nodes are renumbered densely, in the order of
+    // their ids, so the ids are kept as they are unless a node has been
+    // removed.
+    csr_digraph<T, W>
+    freeze () const {
+        std::vector<node_id> dense_ids (_nodes.size(), invalid_node);
+        node_id              next = 0;
+        for (const auto& ptr : _nodes) {
+            if (ptr) dense_ids[ptr->id()] = next++;
+        }
+
+        std::vector<std::string_view>              labels;
+        std::vector<T>                             data;
+        std::vector<size_t>                        offsets;
+        std::vector<node_id>                       targets;
+        typename csr_digraph<T, W>::weight_vector weights;
+
+        labels.reserve (size());
+        data.reserve (size());
+        offsets.reserve (size() + 1);
+        targets.reserve (count_connections());
+        if constexpr (csr_digraph<T, W>::weighted) weights.reserve (targets.capacity());
+
+        offsets.push_back (0);
+        for (const auto& ptr : _nodes) {
+            if (!ptr) continue;
+
+            labels.push_back (ptr->label());
+            data.push_back (*ptr->data());
+
+            const auto& edges = ptr->edges();
+            for (size_t i = 0; i < edges.size(); ++i) {
+                targets.push_back (dense_ids[edges[i]->id()]);
+                if constexpr (csr_digraph<T, W>::weighted) weights.push_back (edges.weight (i));
+            }
+            offsets.push_back (targets.size());
+        }
+
+        return {
+            std::move (labels),
+            std::move (data),
+            std::move (offsets),
+            std::move (targets),
+            std::move (weights)
+        };
+    }
+
+    // Builds a graph from (head, tail) label pairs in one pass.  The nodes are
+    // created in order of first appearance, so a label's node id is its rank
+    // among the distinct labels.  Duplicate pairs are dropped, and every edge
+    // buffer is sized once.  On a weighted graph, the edges get
+    // value-initialized weights.  Sorting and deduplicating the edges of each
+    // node is split across `threads` threads (0 means as many as the hardware
+    // runs concurrently).
+    static digraph
+    from_edges (
+        std::span<const std::pair<std::string, std::string>> edges,
+        const size_t                                         threads = 0
+    ) {
+        digraph gr;
+
+        // Label pass: interning into an empty pool numbers the labels in
+        // order, which is also the order the nodes are created in.
+        std::vector<node_id> heads (edges.size());
+        std::vector<node_id> tails (edges.size());
+        for (size_t i = 0; i < edges.size(); ++i) {
+            heads[i] = gr._labels.intern (edges[i].first);
+            tails[i] = gr._labels.intern (edges[i].second);
+        }
+
+        const auto n = gr._labels.size();
+        gr._nodes.reserve (n);
+        gr._symbol_nodes.reserve (n);
+        for (node_id id = 0; id < n; ++id) {
+            gr._nodes.push_back (
+                gr._node_pool.create (gr._labels.view (id), T(), id, gr._edge_resource.get())
+            );
+            gr._symbol_nodes.push_back (id);
+        }
+
+        // Group the tails by head, then sort and deduplicate each group.
+        auto [offsets, targets] = group_by (heads, tails, n);
+        heads                   = {};
+        tails                   = {};
+
+        std::vector<size_t> degrees (n);
+        parallel_for (
             0,
-            [] (const size_t& acc, const auto& node) { return node->count_connections() + acc; }
+            n,
+            [&] (const size_t lo, const size_t hi) {
+                for (size_t id = lo; id < hi; ++id) {
+                    auto first = targets.begin() + offsets[id];
+                    auto last  = targets.begin() + offsets[id + 1];
+                    std::sort (first, last);
+                    degrees[id] = std::unique (first, last) - first;
+                }
+            },
+            threads
         );
+
+        // Fill the outgoing edges, and count the incoming ones.
+        const auto to_node = [&gr] (const node_id id) { return gr._nodes[id]; };
+
+        std::vector<size_t> in_offsets (n + 1, 0);
+        for (node_id id = 0; id < n; ++id) {
+            auto row = std::span{targets}.subspan (offsets[id], degrees[id]);
+            auto ptr = std::views::transform (row, to_node);
+            gr._nodes[id]->_edges.assign (ptr.begin(), ptr.end());
+
+            for (const auto tail : row) {
+                ++in_offsets[tail + 1];
+            }
+        }
+        std::partial_sum (in_offsets.begin(), in_offsets.end(), in_offsets.begin());
+
+        // Group the heads by tail.  Scanning the heads in order keeps each
+        // group sorted and free of duplicates.
+        std::vector<node_id> sources (in_offsets.back());
+        std::vector<size_t>  cursor (in_offsets.begin(), in_offsets.end() - 1);
+        for (node_id id = 0; id < n; ++id) {
+            for (const auto tail : std::span{targets}.subspan (offsets[id], degrees[id])) {
+                sources[cursor[tail]++] = id;
+            }
+        }
+        targets = {};
+
+        for (node_id id = 0; id < n; ++id) {
+            auto row = std::span{sources}.subspan (in_offsets[id], cursor[id] - in_offsets[id]);
+            auto ptr = std::views::transform (row, to_node);
+            gr._nodes[id]->_in_edges.assign (ptr.begin(), ptr.end());
+        }
+
+        return gr;
     }
 
 private:
     node_ptr
-    node_with_label (const std::string& label) {
-        return const_cast<node_ptr> (static_cast<const digraph*> (this)->node_with_label (label));
+    node_with_id (const node_id id) const {
+        if (id >= _nodes.size()) return nullptr;
+
+        return _nodes[id];
     }
 
-    const node_ptr
+    node_ptr
     node_with_label (const std::string& label) const {
-        auto iter = std::find_if (_nodes.cbegin(), _nodes.cend(), [&label] (const auto& ptr) {
-            return ptr->label() == label;
-        });
+        auto symbol = _labels.find (label);
+        if (!symbol || _symbol_nodes[*symbol] == invalid_node) return nullptr;
 
-        if (iter == _nodes.cend()) return nullptr;
+        return _nodes[_symbol_nodes[*symbol]];
+    }
+
+    // Counting sort of `values` by `keys`, which are smaller than `n`.
+    // Returns the offsets of each key's group and the grouped values.
+    static std::pair<std::vector<size_t>, std::vector<node_id>>
+    group_by (
+        const std::vector<node_id>& keys,
+        const std::vector<node_id>& values,
+        const size_t                n
+    ) {
+        std::vector<size_t> offsets (n + 1, 0);
+        for (const auto key : keys) {
+            ++offsets[key + 1];
+        }
+        std::partial_sum (offsets.begin(), offsets.end(), offsets.begin());
+
+        std::vector<node_id> grouped (values.size());
+        std::vector<size_t>  cursor (offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            grouped[cursor[keys[i]]++] = values[i];
+        }
+
+        return {std::move (offsets), std::move (grouped)};
+    }
 
-        return iter->get();
+    // Creates a node holding `data`, forwarded from either `create_node`.
+    template <typename D>
+    node_id
+    emplace_node (const std::string& label, D&& data) {
+        const auto symbol = _labels.intern (label);
+        if (symbol == _symbol_nodes.size()) _symbol_nodes.push_back (invalid_node);
+
+        // Ignore if the label already exists in the list of nodes.
+        if (_symbol_nodes[symbol] != invalid_node) return _symbol_nodes[symbol];
+
+        node_id id = static_cast<node_id> (_nodes.size());
+        if (!_free_ids.empty()) {
+            id = _free_ids.back();
+            _free_ids.pop_back();
+        }
+        else {
+            _nodes.emplace_back();
+        }
+
+        _nodes[id] =
+            _node_pool.create (_labels.view (symbol), std::forward<D> (data), id, _edge_resource.get());
+        _symbol_nodes[symbol] = id;
+        return id;
+    }
+
+    static std::unique_ptr<std::pmr::unsynchronized_pool_resource>
+    make_edge_resource () {
+        return std::make_unique<std::pmr::unsynchronized_pool_resource>();
+    }
+
+    // Nodes only hold memory from `_edge_resource` and `_node_pool`, which
+    // release it in bulk.  Their destructors are run only when the data needs
+    // it, so that dropping a large graph does not visit every node.
+    void
+    destroy_nodes () {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (auto ptr : _nodes) {
+                if (ptr != nullptr) _node_pool.destroy (ptr);
+            }
+        }
+        _nodes.clear();
     }
 };
 
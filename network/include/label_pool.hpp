@@ -0,0 +1,142 @@
+//
+// label_pool.hpp
+//
+// Interning Pool for Node Labels
+//
+
+#ifndef __GPW_FOUNDATION_LABEL_POOL__
+#define __GPW_FOUNDATION_LABEL_POOL__
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gpw::foundation {
+
+/*******************************************************************************
+ *
+ * @class label_pool
+ *
+ */
+class label_pool {
+public:
+    // Dense integer identifier of an interned label, in order of interning.
+    using symbol = std::uint32_t;
+
+private:
+    // The characters of every label are stored once, back to back, in the
+    // blocks of a monotonic resource, which also holds the nodes of the hash
+    // table.  Labels are never removed, so nothing is ever freed before the
+    // pool itself.  A block is never reallocated, so the views handed out stay
+    // valid for the lifetime of the pool.  The resource and the table live
+    // together on the heap, so that moving the pool moves a single pointer;
+    // copying it stores every label again.
+    struct storage {
+        std::pmr::monotonic_buffer_resource               resource;
+        std::pmr::unordered_map<std::string_view, symbol> symbols{&resource};
+    };
+
+    std::unique_ptr<storage>      _storage = std::make_unique<storage>();
+    std::vector<std::string_view> _views;
+    size_t                        _bytes = 0;
+
+public:
+    label_pool () {}
+
+    // A copy stores the labels anew, in the same order, so that they keep
+    // their symbols and its views refer to its own storage.
+    label_pool (const label_pool& other) {
+        reserve (other.size());
+        for (const auto label : other._views) {
+            intern (label);
+        }
+    }
+
+    label_pool&
+    operator= (const label_pool& other) {
+        if (this != &other) *this = label_pool{other};
+        return *this;
+    }
+
+    // The moved-from pool is left empty, with storage of its own.
+    label_pool (label_pool&& other)
+        : _storage{std::exchange (other._storage, std::make_unique<storage>())}
+        , _views{std::exchange (other._views, {})}
+        , _bytes{std::exchange (other._bytes, 0)} {}
+
+    label_pool&
+    operator= (label_pool&& other) {
+        if (this != &other) {
+            _storage = std::exchange (other._storage, std::make_unique<storage>());
+            _views   = std::exchange (other._views, {});
+            _bytes   = std::exchange (other._bytes, 0);
+        }
+        return *this;
+    }
+
+    // Returns the symbol of `label`, storing the label first if it is new.
+    symbol
+    intern (const std::string_view label) {
+        auto& symbols = _storage->symbols;
+        if (auto iter = symbols.find (label); iter != symbols.end()) return iter->second;
+
+        const auto id = static_cast<symbol> (_views.size());
+        const auto sv = store (label);
+        symbols.emplace (sv, id);
+        _views.push_back (sv);
+        return id;
+    }
+
+    std::optional<symbol>
+    find (const std::string_view label) const {
+        auto iter = _storage->symbols.find (label);
+        if (iter == _storage->symbols.end()) return std::nullopt;
+
+        return iter->second;
+    }
+
+    // The returned view refers to the pool's own copy of the label.
+    std::string_view
+    view (const symbol id) const {
+        return _views[id];
+    }
+
+    // Number of distinct labels.
+    size_t
+    size () const {
+        return _views.size();
+    }
+
+    // Bytes taken by the characters of the labels.
+    size_t
+    bytes () const {
+        return _bytes;
+    }
+
+    void
+    reserve (const size_t count) {
+        _storage->symbols.reserve (count);
+        _views.reserve (count);
+    }
+
+private:
+    std::string_view
+    store (const std::string_view label) {
+        if (label.empty()) return {};
+
+        auto dst = static_cast<char*> (_storage->resource.allocate (label.size(), alignof (char)));
+        std::copy (label.begin(), label.end(), dst);
+        _bytes += label.size();
+        return {dst, label.size()};
+    }
+};
+
+}  // namespace gpw::foundation
+
+#endif
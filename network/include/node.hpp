@@ -1,65 +1,149 @@
 #ifndef __GPW_FOUNDATION_NODE__
 #define __GPW_FOUNDATION_NODE__
 
+#include "adjacency.hpp"
+
 #include <algorithm>
-#include <list>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace gpw::foundation {
 
+// Dense integer identifier of a node within a graph.
+using node_id = std::uint32_t;
+
+// Identifier of a node that does not belong to any graph.
+inline constexpr node_id invalid_node = std::numeric_limits<node_id>::max();
+
+template <typename T, typename W> class digraph;
+
 /*******************************************************************************
  *
  * @class node
  *
  */
-template <typename T> class node {
+template <typename T, typename W = void> class node {
     // Note that this `node` type does not manage memory resources.
     // Connection or disconnection to other nodes only adds or removes raw pointer
     // to the nodes WITHOUT creation or deletion of the object.
-    using node_ptr = node<T>*;
+    // Likewise, the label is only viewed: the characters belong to the caller
+    // (normally the `label_pool` of the owning graph) and must outlive the node.
+    using node_ptr = node<T, W>*;
 
-    std::string         _label;
-    T                   _data;
-    std::list<node_ptr> _edges;
+    // Each outgoing edge carries a weight of type `W`, unless `W` is void.
+    // The incoming edges only mirror the outgoing ones and carry no weight.
+    std::string_view       _label;
+    node_id                _id;
+    T                      _data;
+    adjacency<node_ptr, W> _edges;
+
+    // Nodes with an edge to this node.  It mirrors `_edges` of those nodes,
+    // so that a node can be detached by visiting its neighbors only.
+    adjacency<node_ptr> _in_edges;
+
+    // Bulk construction fills both sides of the edges directly.
+    friend class digraph<T, W>;
 
 public:
     node () = delete;
-    node (const std::string_view lb, const T& dt = T())
+    // The edge buffers of the node are allocated from `resource`.
+    node (
+        const std::string_view     lb,
+        T                          dt       = T(),
+        const node_id              id       = invalid_node,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+    )
         : _label{lb}
-        , _data{dt} {}
+        , _id{id}
+        , _data{std::move (dt)}
+        , _edges{resource}
+        , _in_edges{resource} {}
 
     std::optional<T>
     data () const {
         return _data;
     }
 
-    std::string
+    void
+    set_data (const T& dt) {
+        _data = dt;
+    }
+
+    std::string_view
     label () const {
         return _label;
     }
 
-    const std::list<node_ptr>&
+    // Identifier assigned by the graph that owns this node.
+    node_id
+    id () const {
+        return _id;
+    }
+
+    const adjacency<node_ptr, W>&
     edges () const {
         return _edges;
     }
 
+    const adjacency<node_ptr>&
+    in_edges () const {
+        return _in_edges;
+    }
+
+    // On a weighted node, a new edge gets a value-initialized weight, and an
+    // existing one keeps its weight.
+    void
+    connect (node& ch) {
+        if constexpr (adjacency<node_ptr, W>::weighted) {
+            if (_edges.contains (&ch)) return;
+            connect (ch, W{});
+        }
+        else {
+            if (_edges.insert (&ch)) ch._in_edges.insert (this);
+        }
+    }
+
+    // Connecting an already connected node only updates the weight.
+    template <typename U = W>
+        requires (!std::is_void_v<U>)
     void
-    connect (node<T>& ch) {
-        if (is_connected (ch)) return;
+    connect (node& ch, const U& weight) {
+        if (_edges.insert (&ch, weight)) ch._in_edges.insert (this);
+    }
 
-        _edges.push_back (&ch);
+    void
+    disconnect (node& ch) {
+        if (_edges.erase (&ch)) ch._in_edges.erase (this);
     }
 
     void
-    disconnect (node<T>& ch) {
-        _edges.remove (&ch);
+    disconnect (const std::string_view label) {
+        _edges.erase_if ([this, &label] (auto& node_ptr) {
+            if (!same_label (node_ptr->_label, label)) return false;
+
+            node_ptr->_in_edges.erase (this);
+            return true;
+        });
     }
 
+    // Removes every edge from and to this node.
     void
-    disconnect (const std::string& label) {
-        std::erase_if (_edges, [&label] (auto& node_ptr) { return node_ptr->_label == label; });
+    isolate () {
+        while (!_in_edges.empty()) {
+            _in_edges[0]->disconnect (*this);
+        }
+        while (!_edges.empty()) {
+            disconnect (*_edges[0]);
+        }
     }
 
     size_t
@@ -67,16 +151,30 @@ public:
         return _edges.size();
     }
 
+    size_t
+    in_degree () const {
+        return _in_edges.size();
+    }
+
     bool
-    is_connected (const node<T>& node) const {
-        if (std::find (_edges.cbegin(), _edges.cend(), &node) == _edges.cend()) return false;
+    is_connected (const node& node) const {
+        return _edges.contains (const_cast<node_ptr> (&node));
+    }
 
-        return true;
+    // Weight of the edge to `ch`, if they are connected.
+    template <typename U = W>
+        requires (!std::is_void_v<U>)
+    std::optional<U>
+    weight (const node& ch) const {
+        const auto pos = _edges.position (const_cast<node_ptr> (&ch));
+        if (pos == _edges.size()) return std::nullopt;
+
+        return _edges.weight (pos);
     }
 
     std::string
     description (bool recursion = false) const noexcept {
-        std::vector<std::string> connected_labels;
+        std::vector<std::string_view> connected_labels;
         std::transform (
             _edges.cbegin(),
             _edges.cend(),
@@ -90,7 +188,9 @@ public:
         if (connected_labels.cbegin() != connected_labels.cend()) {
             auto last = connected_labels.cend() - 1;
             std::copy (
-                connected_labels.cbegin(), last, std::ostream_iterator<std::string> (strm, ", ")
+                connected_labels.cbegin(),
+                last,
+                std::ostream_iterator<std::string_view> (strm, ", ")
             );
             strm << *last;
         }
@@ -104,6 +204,16 @@ public:
 
         return strm.str();
     }
+
+private:
+    // Labels interned in the same pool are equal exactly when they share
+    // their storage, which is checked before comparing the characters.
+    static bool
+    same_label (const std::string_view lhs, const std::string_view rhs) {
+        if (lhs.data() == rhs.data() && lhs.size() == rhs.size()) return true;
+
+        return lhs == rhs;
+    }
 };
 
 }  // namespace gpw::foundation
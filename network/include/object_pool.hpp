@@ -0,0 +1,95 @@
+//
+// object_pool.hpp
+//
+// Chunked Storage for Objects of a Single Type
+//
+
+#ifndef __GPW_FOUNDATION_OBJECT_POOL__
+#define __GPW_FOUNDATION_OBJECT_POOL__
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace gpw::foundation {
+
+/*******************************************************************************
+ *
+ * @class object_pool
+ *
+ */
+template <typename U, size_t ChunkSize = 1024> class object_pool {
+    // Objects are carved out of chunks of `ChunkSize` slots, so that creating
+    // many of them takes one allocation per chunk.  A destroyed object's slot
+    // goes to a free list threaded through the slots themselves, and is used
+    // again by the next `create`.
+    union slot {
+        slot* next;
+        alignas (U) std::byte storage[sizeof (U)];
+    };
+
+    std::vector<std::unique_ptr<slot[]>> _chunks;
+    size_t                               _chunk_used = ChunkSize;
+    slot*                                _free       = nullptr;
+
+public:
+    object_pool () {}
+
+    // The moved-from pool is left empty.
+    object_pool (object_pool&& other)
+        : _chunks{std::exchange (other._chunks, {})}
+        , _chunk_used{std::exchange (other._chunk_used, ChunkSize)}
+        , _free{std::exchange (other._free, nullptr)} {}
+
+    object_pool&
+    operator= (object_pool&& other) {
+        if (this != &other) {
+            _chunks     = std::exchange (other._chunks, {});
+            _chunk_used = std::exchange (other._chunk_used, ChunkSize);
+            _free       = std::exchange (other._free, nullptr);
+        }
+        return *this;
+    }
+
+    // The memory of every object is released at once, WITHOUT running their
+    // destructors.  The owner destroys the objects that need it beforehand.
+    ~object_pool () {}
+
+    template <typename... Args>
+    U*
+    create (Args&&... args) {
+        slot* s = _free;
+        if (s != nullptr) {
+            _free = s->next;
+        }
+        else {
+            if (_chunk_used == ChunkSize) {
+                _chunks.push_back (std::make_unique_for_overwrite<slot[]> (ChunkSize));
+                _chunk_used = 0;
+            }
+            s = &_chunks.back()[_chunk_used++];
+        }
+
+        return ::new (static_cast<void*> (s->storage)) U (std::forward<Args> (args)...);
+    }
+
+    void
+    destroy (U* object) {
+        object->~U();
+
+        auto s  = reinterpret_cast<slot*> (object);
+        s->next = _free;
+        _free   = s;
+    }
+
+    size_t
+    chunk_count () const {
+        return _chunks.size();
+    }
+};
+
+}  // namespace gpw::foundation
+
+#endif
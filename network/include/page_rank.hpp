@@ -0,0 +1,190 @@
+//
+// page_rank.hpp
+//
+// PageRank and Personalized PageRank over a Frozen Graph
+//
+
+#ifndef __GPW_FOUNDATION_PAGE_RANK__
+#define __GPW_FOUNDATION_PAGE_RANK__
+
+#include "csr_digraph.hpp"
+#include "node.hpp"
+#include "parallel.hpp"
+
+#include <cmath>
+#include <concepts>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace gpw::foundation {
+
+struct page_rank_options {
+    // Probability that the walk follows an edge rather than jumping.
+    double damping = 0.85;
+
+    // The iteration stops once the scores move by less than this in total
+    // (L1 norm) from one iteration to the next, or after `max_iterations`.
+    double tolerance      = 1e-6;
+    size_t max_iterations = 100;
+
+    // 0 means as many threads as the hardware runs concurrently.
+    size_t threads = 0;
+};
+
+// Score of every node, indexed by node id, summing to 1.  `iterations` is
+// the number of iterations run, and `converged` whether the last one moved
+// the scores by less than the tolerance.
+template <std::floating_point R> struct page_rank_scores {
+    std::vector<R> score;
+    size_t         iterations = 0;
+    bool           converged  = false;
+};
+
+namespace detail {
+
+// Power iteration where the walk jumps to node `v` with probability
+// `teleport[v]`, which sums to 1.  The walk also jumps from nodes without
+// outgoing edges, so that no score leaks out.
+//
+// Each node pulls the scores of its predecessors along its incoming edges,
+// so every score is written by one thread only and no atomics are needed.
+// The share a node passes along each edge, its score over its out-degree, is
+// computed once per iteration into a dense array, where the pulls gather
+// it; the updates themselves are plain loops over dense arrays.
+template <std::floating_point R, typename T, typename W>
+page_rank_scores<R>
+page_rank (
+    const csr_digraph<T, W>& gr,
+    const std::vector<R>&    teleport,
+    const page_rank_options& opts
+) {
+    // Graphs smaller than this are ranked by the calling thread alone.
+    constexpr size_t parallel_grain = 4096;
+
+    const auto          n = gr.size();
+    page_rank_scores<R> result;
+    if (n == 0) {
+        result.converged = true;
+        return result;
+    }
+
+    const auto d       = static_cast<R> (opts.damping);
+    const auto threads = n < parallel_grain ? 1 : opts.threads;
+
+    // 1 / out-degree, or 0 for the nodes without outgoing edges.
+    std::vector<R> inverse_degree (n);
+    for (node_id id = 0; id < n; ++id) {
+        const auto degree  = gr.count_connections (id);
+        inverse_degree[id] = degree == 0 ? R{0} : R{1} / static_cast<R> (degree);
+    }
+
+    auto&          score = result.score;
+    std::vector<R> next (n);
+    std::vector<R> share (n);
+    std::vector<R> next_share (n);
+
+    // Score held by the nodes without outgoing edges, which the walk spreads
+    // as it does when it jumps.
+    R dangling{0};
+
+    score.assign (teleport.begin(), teleport.end());
+    for (node_id id = 0; id < n; ++id) {
+        share[id] = score[id] * inverse_degree[id];
+        if (inverse_degree[id] == R{0}) dangling += score[id];
+    }
+
+    std::mutex merge_lock;
+    while (result.iterations < opts.max_iterations) {
+        ++result.iterations;
+
+        // Every node reached by a jump, or from a dangling node, gets the
+        // same share of its teleport probability.
+        const auto jump = (R{1} - d) + d * dangling;
+
+        R next_dangling{0};
+        R change{0};
+        parallel_for (
+            0,
+            n,
+            [&] (const size_t lo, const size_t hi) {
+                for (auto id = static_cast<node_id> (lo); id < hi; ++id) {
+                    R sum{0};
+                    for (const auto head : gr.in_edges (id)) {
+                        sum += share[head];
+                    }
+                    next[id] = jump * teleport[id] + d * sum;
+                }
+
+                R local_dangling{0};
+                R local_change{0};
+                for (auto i = lo; i < hi; ++i) {
+                    next_share[i] = next[i] * inverse_degree[i];
+                    local_change += std::abs (next[i] - score[i]);
+                    if (inverse_degree[i] == R{0}) local_dangling += next[i];
+                }
+
+                std::scoped_lock lock{merge_lock};
+                next_dangling += local_dangling;
+                change += local_change;
+            },
+            threads
+        );
+
+        score.swap (next);
+        share.swap (next_share);
+        dangling = next_dangling;
+
+        if (change < static_cast<R> (opts.tolerance)) {
+            result.converged = true;
+            break;
+        }
+    }
+
+    return result;
+}
+
+}  // namespace detail
+
+// PageRank of every node of a frozen graph: the probability of finding at
+// that node a random walk that follows a random outgoing edge with
+// probability `opts.damping` and otherwise jumps to a random node.  `R`
+// sets the precision of the scores; `float` halves the memory traffic.
+template <std::floating_point R = double, typename T, typename W>
+page_rank_scores<R>
+page_rank (const csr_digraph<T, W>& gr, const page_rank_options& opts = {}) {
+    const auto n = gr.size();
+    return detail::page_rank (gr, std::vector<R> (n, R{1} / static_cast<R> (n)), opts);
+}
+
+// Personalized PageRank: the same walk, but it jumps only to the nodes of
+// `seeds`, so that the scores measure how close each node is to them.
+// Nodes that no seed reaches score 0.  Ids out of range are ignored, and
+// without any valid seed every score is 0.
+template <std::floating_point R = double, typename T, typename W>
+page_rank_scores<R>
+personalized_page_rank (
+    const csr_digraph<T, W>&       gr,
+    const std::span<const node_id> seeds,
+    const page_rank_options&       opts = {}
+) {
+    const auto     n = gr.size();
+    std::vector<R> teleport (n, R{0});
+    size_t         count = 0;
+    for (const auto id : seeds) {
+        if (id >= n || teleport[id] != R{0}) continue;
+
+        teleport[id] = R{1};
+        ++count;
+    }
+    if (count == 0) return {std::vector<R> (n, R{0}), 0, true};
+
+    for (auto& p : teleport) {
+        p /= static_cast<R> (count);
+    }
+    return detail::page_rank (gr, teleport, opts);
+}
+
+}  // namespace gpw::foundation
+
+#endif
@@ -0,0 +1,51 @@
+//
+// parallel.hpp
+//
+// Helpers for Splitting Loops Across Threads
+//
+
+#ifndef __GPW_FOUNDATION_PARALLEL__
+#define __GPW_FOUNDATION_PARALLEL__
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace gpw::foundation {
+
+// Number of threads to use when the caller asks for `requested` (0 means as
+// many as the hardware runs concurrently).
+inline size_t
+thread_count (const size_t requested = 0) {
+    if (requested != 0) return requested;
+
+    return std::max<size_t> (1, std::thread::hardware_concurrency());
+}
+
+// Splits [begin, end) into one contiguous block per thread and calls
+// `fn (block_begin, block_end)` for each block.  The calling thread takes the
+// first block.  Returns after every block is done.
+template <typename F>
+void
+parallel_for (const size_t begin, const size_t end, F&& fn, const size_t threads = 0) {
+    if (begin >= end) return;
+
+    const auto count = std::min (thread_count (threads), end - begin);
+    const auto chunk = (end - begin + count - 1) / count;
+
+    std::vector<std::jthread> workers;
+    workers.reserve (count - 1);
+    for (size_t i = 1; i < count; ++i) {
+        const auto lo = begin + i * chunk;
+        const auto hi = std::min (end, lo + chunk);
+        if (lo >= hi) break;
+
+        workers.emplace_back ([&fn, lo, hi] { fn (lo, hi); });
+    }
+
+    fn (begin, std::min (end, begin + chunk));
+}
+
+}  // namespace gpw::foundation
+
+#endif
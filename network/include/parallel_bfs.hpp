@@ -0,0 +1,249 @@
+//
+// parallel_bfs.hpp
+//
+// Direction-Optimizing Parallel Breadth-First Search over a Frozen Graph
+//
+
+#ifndef __GPW_FOUNDATION_PARALLEL_BFS__
+#define __GPW_FOUNDATION_PARALLEL_BFS__
+
+#include "csr_digraph.hpp"
+#include "node.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace gpw::foundation {
+
+// Result of a breadth-first search: for every node, the node it was reached
+// from and its distance in edges from the source.  The source is its own
+// parent, and a node that was not reached has `invalid_node` as its parent
+// and `unreached` as its depth.
+struct breadth_first_tree {
+    static constexpr std::uint32_t unreached = std::numeric_limits<std::uint32_t>::max();
+
+    std::vector<node_id>       parent;
+    std::vector<std::uint32_t> depth;
+};
+
+namespace detail {
+
+// One bit per node.
+class node_bitmap {
+    std::vector<std::uint64_t> _words;
+
+public:
+    static constexpr size_t bits = 64;
+
+    explicit node_bitmap (const size_t count)
+        : _words ((count + bits - 1) / bits, 0) {}
+
+    size_t
+    word_count () const {
+        return _words.size();
+    }
+
+    bool
+    test (const node_id id) const {
+        return (_words[id / bits] >> (id % bits)) & 1;
+    }
+
+    void
+    set (const node_id id) {
+        _words[id / bits] |= std::uint64_t{1} << (id % bits);
+    }
+
+    std::uint64_t&
+    word (const size_t i) {
+        return _words[i];
+    }
+
+    void
+    clear () {
+        std::fill (_words.begin(), _words.end(), 0);
+    }
+
+    // Appends the ids whose bit is set to `ids`, in increasing order.
+    void
+    collect (std::vector<node_id>& ids) const {
+        for (size_t i = 0; i < _words.size(); ++i) {
+            for (auto word = _words[i]; word != 0; word &= word - 1) {
+                ids.push_back (static_cast<node_id> (i * bits + std::countr_zero (word)));
+            }
+        }
+    }
+};
+
+}  // namespace detail
+
+// Breadth-first search from `source`, split across `threads` threads (0 means
+// as many as the hardware runs concurrently).
+//
+// Each level is expanded either top-down, from the frontier along the
+// outgoing edges, or bottom-up, from every unreached node along its incoming
+// edges until one of them is in the frontier.  Top-down is cheaper while the
+// frontier is small; once the edges leaving the frontier outnumber a fraction
+// of the edges left unexplored, bottom-up finds the next level while
+// scanning far fewer edges.  The search returns to top-down when the
+// frontier shrinks again (Beamer, Asanović and Patterson, "Direction-
+// Optimizing Breadth-First Search", 2012).
+//
+// Top-down keeps the frontier as a list of ids, and nodes are claimed by an
+// atomic compare-and-swap on their parent.  Bottom-up keeps it as a bitmap,
+// and every thread owns whole words of the next bitmap, so it needs no
+// atomics at all.
+template <typename T, typename W>
+breadth_first_tree
+parallel_breadth_first (
+    const csr_digraph<T, W>& gr,
+    const node_id            source,
+    const size_t             threads = 0
+) {
+    // Switching thresholds suggested in the paper.
+    constexpr size_t alpha = 15;
+    constexpr size_t beta  = 18;
+
+    // Levels smaller than this are expanded by the calling thread alone, so
+    // that long chains of tiny frontiers do not pay for starting threads.
+    constexpr size_t parallel_grain = 4096;
+
+    const auto         n = gr.size();
+    breadth_first_tree result{
+        std::vector<node_id> (n, invalid_node),
+        std::vector<std::uint32_t> (n, breadth_first_tree::unreached)
+    };
+    if (source >= n) return result;
+
+    auto& parent = result.parent;
+    auto& depth  = result.depth;
+
+    parent[source] = source;
+    depth[source]  = 0;
+
+    std::vector<node_id> frontier{source};
+    std::vector<node_id> next;
+    detail::node_bitmap  front_bits{n};
+    detail::node_bitmap  next_bits{n};
+    std::mutex           merge_lock;
+
+    // Edges not yet explored, and edges leaving the current frontier.
+    size_t        unexplored = gr.count_connections();
+    size_t        scout      = gr.count_connections (source);
+    std::uint32_t level      = 0;
+
+    // One top-down level: claims the unreached tails of the edges leaving
+    // the frontier.  Returns the number of edges leaving the next frontier.
+    const auto top_down = [&] {
+        std::atomic<size_t> next_scout{0};
+        next.clear();
+
+        const auto expand = [&] (const size_t lo, const size_t hi) {
+            std::vector<node_id> local;
+            size_t               local_scout = 0;
+            for (size_t i = lo; i < hi; ++i) {
+                const auto head = frontier[i];
+                for (const auto tail : gr.edges (head)) {
+                    std::atomic_ref<node_id> slot{parent[tail]};
+
+                    auto expected = invalid_node;
+                    if (slot.load (std::memory_order_relaxed) != invalid_node) continue;
+                    if (!slot.compare_exchange_strong (expected, head, std::memory_order_relaxed)) {
+                        continue;
+                    }
+
+                    depth[tail] = level;
+                    local.push_back (tail);
+                    local_scout += gr.count_connections (tail);
+                }
+            }
+
+            next_scout += local_scout;
+            std::scoped_lock lock{merge_lock};
+            next.insert (next.end(), local.begin(), local.end());
+        };
+
+        const auto workers = frontier.size() < parallel_grain ? 1 : threads;
+        parallel_for (0, frontier.size(), expand, workers);
+        frontier.swap (next);
+        return next_scout.load();
+    };
+
+    // One bottom-up level: every unreached node looks for a parent in the
+    // frontier.  Returns the size of the next frontier, and sets `scout` to
+    // the number of edges leaving it.
+    const auto bottom_up = [&] {
+        std::atomic<size_t> awake{0};
+        std::atomic<size_t> next_scout{0};
+
+        const auto expand = [&] (const size_t lo, const size_t hi) {
+            size_t local_awake = 0;
+            size_t local_scout = 0;
+            for (size_t w = lo; w < hi; ++w) {
+                std::uint64_t bits = 0;
+
+                const auto first = w * detail::node_bitmap::bits;
+                const auto last  = std::min (n, first + detail::node_bitmap::bits);
+                for (auto id = static_cast<node_id> (first); id < last; ++id) {
+                    if (parent[id] != invalid_node) continue;
+
+                    for (const auto head : gr.in_edges (id)) {
+                        if (!front_bits.test (head)) continue;
+
+                        parent[id] = head;
+                        depth[id]  = level;
+                        bits |= std::uint64_t{1} << (id - first);
+                        ++local_awake;
+                        local_scout += gr.count_connections (id);
+                        break;
+                    }
+                }
+                next_bits.word (w) = bits;
+            }
+            awake += local_awake;
+            next_scout += local_scout;
+        };
+
+        parallel_for (0, front_bits.word_count(), expand, threads);
+        std::swap (front_bits, next_bits);
+        scout = next_scout.load();
+        return awake.load();
+    };
+
+    while (!frontier.empty()) {
+        if (scout > unexplored / alpha) {
+            front_bits.clear();
+            for (const auto id : frontier) {
+                front_bits.set (id);
+            }
+
+            size_t awake = frontier.size();
+            size_t previous;
+            do {
+                previous = awake;
+                unexplored -= std::min (unexplored, scout);
+                ++level;
+                awake = bottom_up();
+            } while (awake >= previous || awake > n / beta);
+
+            frontier.clear();
+            front_bits.collect (frontier);
+        }
+        else {
+            unexplored -= std::min (unexplored, scout);
+            ++level;
+            scout = top_down();
+        }
+    }
+
+    return result;
+}
+
+}  // namespace gpw::foundation
+
+#endif
@@ -0,0 +1,174 @@
+//
+// path_aggregate.hpp
+//
+// Aggregates of Node Data along Root Paths of a Tree
+//
+
+#ifndef __GPW_FOUNDATION_PATH_AGGREGATE__
+#define __GPW_FOUNDATION_PATH_AGGREGATE__
+
+#include "node.hpp"
+#include "segment_tree.hpp"
+#include "tree.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gpw::foundation {
+
+/*******************************************************************************
+ *
+ * @class path_aggregate
+ *
+ */
+template <typename T, typename Op = std::plus<T>> class path_aggregate {
+    tree<T>* _tree;
+
+    // Heavy-light decomposition: the child with the largest subtree is the
+    // heavy child of a node, and the edges to heavy children form chains
+    // that start at `_head[i]`.  Any root path crosses O(log N) chains,
+    // since leaving a chain through a light edge at least halves the size of
+    // the subtree.  The nodes of a chain are numbered consecutively from its
+    // head, `_position[i]` being the number of node `i`, so a piece of chain
+    // is a range of `_values`: a path query costs O(log^2 N), and a change of
+    // data O(log N).
+    //
+    // As in `subtree_aggregate`, the nodes appended and the data changed
+    // outside this aggregate since the last `reindex` are not covered until
+    // the next one.
+    std::vector<node_id>       _parent;
+    std::vector<node_id>       _head;
+    std::vector<std::uint32_t> _position;
+    segment_tree<T, Op>        _values;
+
+public:
+    // `op` combines the data of two nodes, and `identity` is its neutral
+    // value (see `subtree_aggregate`).  Data changed through `set_data`
+    // below is followed at once; data changed otherwise only after a
+    // `reindex`.
+    explicit path_aggregate (tree<T>& tr, Op op = Op{}, T identity = T{})
+        : _tree{&tr}
+        , _values{std::move (op), std::move (identity)} {
+        reindex();
+    }
+
+    // Number of nodes covered, those of the tree at the last `reindex`.
+    size_t
+    size () const {
+        return _parent.size();
+    }
+
+    // Combination of the data on the path from the root to `id`, both ends
+    // included, in that order.  `id` must refer to a covered node.
+    T
+    value (const node_id id) const {
+        // The pieces are found from `id` upwards, and put in front of the
+        // ones found before.
+        auto result = _values.identity();
+        for (auto current = id; current != invalid_node; current = _parent[_head[current]]) {
+            const auto piece = _values.query (_position[_head[current]], _position[current] + 1);
+            result           = _values.combine (piece, result);
+        }
+        return result;
+    }
+
+    // Nothing if `label` is not a covered node.
+    std::optional<T>
+    value (const std::string& label) const {
+        const auto found = _tree->id (label);
+        if (!found || *found >= size()) return std::nullopt;
+
+        return value (*found);
+    }
+
+    // Sets the data of `id` in the tree, and updates the aggregates of the
+    // paths through it.  Returns false if `id` is not in the tree.
+    bool
+    set_data (const node_id id, const T& data) {
+        if (!_tree->set_data (id, data)) return false;
+
+        if (id < _position.size()) _values.set (_position[id], data);
+        return true;
+    }
+
+    bool
+    set_data (const std::string& label, const T& data) {
+        const auto found = _tree->id (label);
+        if (!found) return false;
+
+        return set_data (*found, data);
+    }
+
+    // Covers the nodes appended and the data changed in the tree since the
+    // last time, by splitting the whole tree into heavy chains and gathering
+    // its data anew in O(N).  A run of changes is best followed by a single
+    // call.
+    void
+    reindex () {
+        const auto n = _tree->size();
+
+        // A node is appended after its parent, so parents have smaller ids
+        // than their children, and the sizes of the subtrees are summed in
+        // one pass over decreasing ids.
+        _parent.resize (n);
+        std::vector<std::uint32_t> size (n, 1);
+        std::vector<std::uint32_t> first_child (n + 1, 0);
+        for (node_id i = 0; i < n; ++i) {
+            _parent[i] = _tree->parent (i);
+            if (_parent[i] != invalid_node) ++first_child[_parent[i] + 1];
+        }
+        for (auto i = static_cast<node_id> (n); i-- > 1;) {
+            size[_parent[i]] += size[i];
+        }
+
+        // Children grouped by parent: those of node `i` are `children
+        // [first_child[i]]` .. `children[first_child[i + 1] - 1]`.  And the
+        // heavy child of each node.
+        for (size_t i = 1; i <= n; ++i) {
+            first_child[i] += first_child[i - 1];
+        }
+        std::vector<node_id> children (n);
+        std::vector<node_id> heavy (n, invalid_node);
+        {
+            auto next = first_child;
+            for (node_id i = 1; i < n; ++i) {
+                const auto p        = _parent[i];
+                children[next[p]++] = i;
+                if (heavy[p] == invalid_node || size[i] > size[heavy[p]]) heavy[p] = i;
+            }
+        }
+
+        // Numbers each chain in one go from its head, and leaves the light
+        // children met on the way as heads of chains to number later.
+        _head.resize (n);
+        _position.resize (n);
+        std::vector<T> values (n);
+
+        std::uint32_t        counter = 0;
+        std::vector<node_id> heads{_tree->root()};
+        while (!heads.empty()) {
+            const auto head = heads.back();
+            heads.pop_back();
+
+            for (auto current = head; current != invalid_node; current = heavy[current]) {
+                _head[current]     = head;
+                _position[current] = counter;
+                values[counter++]  = *_tree->data (current);
+
+                for (auto c = first_child[current]; c < first_child[current + 1]; ++c) {
+                    if (children[c] != heavy[current]) heads.push_back (children[c]);
+                }
+            }
+        }
+
+        _values.assign (std::move (values));
+    }
+};
+
+}  // namespace gpw::foundation
+
+#endif
@@ -0,0 +1,102 @@
+//
+// segment_tree.hpp
+//
+// Range Aggregates with Point Updates
+//
+
+#ifndef __GPW_FOUNDATION_SEGMENT_TREE__
+#define __GPW_FOUNDATION_SEGMENT_TREE__
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace gpw::foundation {
+
+/*******************************************************************************
+ *
+ * @class segment_tree
+ *
+ */
+template <typename T, typename Op = std::plus<T>> class segment_tree {
+    // Combines two values.  It must be associative, and `_identity` must
+    // leave any value unchanged; it need not be commutative or invertible,
+    // so sums, counts, minima and maxima all fit.
+    Op _op;
+    T  _identity;
+
+    // The values are the leaves `_nodes[n]` .. `_nodes[2n - 1]`, and node `i`
+    // below them combines nodes `2i` and `2i + 1`.  Without a padding to a
+    // power of two, the tree needs exactly 2n values, and it is walked
+    // bottom-up without recursion.
+    size_t         _size = 0;
+    std::vector<T> _nodes;
+
+public:
+    explicit segment_tree (Op op = Op{}, T identity = T{})
+        : _op{std::move (op)}
+        , _identity{std::move (identity)} {}
+
+    // Replaces the contents with `values`, in O(n).
+    void
+    assign (std::vector<T> values) {
+        _size = values.size();
+        _nodes.assign (_size, _identity);
+        _nodes.insert (
+            _nodes.end(),
+            std::make_move_iterator (values.begin()),
+            std::make_move_iterator (values.end())
+        );
+        for (size_t i = _size; i-- > 1;) {
+            _nodes[i] = _op (_nodes[2 * i], _nodes[2 * i + 1]);
+        }
+    }
+
+    size_t
+    size () const {
+        return _size;
+    }
+
+    const T&
+    identity () const {
+        return _identity;
+    }
+
+    T
+    combine (const T& lhs, const T& rhs) const {
+        return _op (lhs, rhs);
+    }
+
+    const T&
+    operator[] (const size_t i) const {
+        return _nodes[_size + i];
+    }
+
+    // Sets value `i` in O(log n).
+    void
+    set (size_t i, T value) {
+        i += _size;
+        _nodes[i] = std::move (value);
+        for (i /= 2; i >= 1; i /= 2) {
+            _nodes[i] = _op (_nodes[2 * i], _nodes[2 * i + 1]);
+        }
+    }
+
+    // Combination of the values `lo` .. `hi - 1`, in order, in O(log n).
+    T
+    query (size_t lo, size_t hi) const {
+        // The parts found on the left and on the right of the range are
+        // combined separately, so that the order is kept.
+        T left  = _identity;
+        T right = _identity;
+        for (lo += _size, hi += _size; lo < hi; lo /= 2, hi /= 2) {
+            if (lo & 1) left = _op (left, _nodes[lo++]);
+            if (hi & 1) right = _op (_nodes[--hi], right);
+        }
+        return _op (left, right);
+    }
+};
+
+}  // namespace gpw::foundation
+
+#endif
@@ -0,0 +1,162 @@
+//
+// shortest_path.hpp
+//
+// Shortest Paths over a Frozen Weighted Graph
+//
+
+#ifndef __GPW_FOUNDATION_SHORTEST_PATH__
+#define __GPW_FOUNDATION_SHORTEST_PATH__
+
+#include "csr_digraph.hpp"
+#include "d_ary_heap.hpp"
+#include "node.hpp"
+#include "traversal.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace gpw::foundation {
+
+/*******************************************************************************
+ *
+ * @class shortest_path_search
+ *
+ */
+template <typename W> class shortest_path_search {
+    static_assert (std::is_arithmetic_v<W>, "edge weights must be numbers");
+
+    // Tentative distances and the node each one was reached from, indexed by
+    // node id.  An entry is meaningful only if the node is marked in the
+    // current run, so that a new run clears nothing and, once the buffers
+    // have grown to the graph, allocates nothing.
+    std::vector<W>       _distance;
+    std::vector<node_id> _parent;
+    detail::visit_marks  _reached{true, 0};
+    d_ary_heap<W>        _heap;
+
+public:
+    // Distance of a node that has not been reached.
+    static constexpr W unreachable = std::numeric_limits<W>::max();
+
+    // `id_bound` sizes the buffers up front; they grow as needed.
+    explicit shortest_path_search (const size_t id_bound = 0)
+        : _distance (id_bound)
+        , _parent (id_bound)
+        , _reached{true, id_bound}
+        , _heap{id_bound} {}
+
+    // Finds the distances from `source` to every node it reaches.  The
+    // weights must not be negative.
+    template <typename T>
+    void
+    dijkstra (const csr_digraph<T, W>& gr, const node_id source) {
+        search (gr, source, invalid_node, [] (node_id) { return W{}; });
+    }
+
+    // Finds the distance from `source` to `target`, and stops as soon as it
+    // is known.  Returns nothing if `target` cannot be reached.
+    template <typename T>
+    std::optional<W>
+    dijkstra (const csr_digraph<T, W>& gr, const node_id source, const node_id target) {
+        return a_star (gr, source, target, [] (node_id) { return W{}; });
+    }
+
+    // Same as `dijkstra`, with the search directed towards `target` by
+    // `heuristic (id)`, an estimate of the distance from `id` to `target`.
+    // The estimate must never exceed the true distance, nor the weight of an
+    // edge plus the estimate from its tail (that is, it must be consistent).
+    template <typename T, typename H>
+    std::optional<W>
+    a_star (
+        const csr_digraph<T, W>& gr,
+        const node_id            source,
+        const node_id            target,
+        H&&                      heuristic
+    ) {
+        if (target >= gr.size() || !search (gr, source, target, heuristic)) return std::nullopt;
+
+        return _distance[target];
+    }
+
+    // Distance from the source of the last search, or `unreachable`.  After a
+    // search that stopped at its target, only the distances of the nodes on
+    // the way are final.
+    W
+    distance (const node_id id) const {
+        return _reached.marked (id) ? _distance[id] : unreachable;
+    }
+
+    // A shortest path from the source of the last search to `target`, both
+    // ends included, or an empty path if `target` has not been reached.
+    std::vector<node_id>
+    path (const node_id target) const {
+        if (!_reached.marked (target)) return {};
+
+        std::vector<node_id> path;
+        for (auto id = target; id != invalid_node; id = _parent[id]) {
+            path.push_back (id);
+        }
+        std::reverse (path.begin(), path.end());
+        return path;
+    }
+
+private:
+    // Settles the nodes in order of distance plus estimate, until `target`
+    // (or every reachable node, if `target` is `invalid_node`) is settled.
+    // With a consistent estimate, a node that has left the heap is final.
+    // Returns whether `target` was reached.
+    template <typename T, typename H>
+    bool
+    search (
+        const csr_digraph<T, W>& gr,
+        const node_id            source,
+        const node_id            target,
+        H&&                      heuristic
+    ) {
+        _heap.clear();
+        _reached.clear();
+        if (_distance.size() < gr.size()) {
+            _distance.resize (gr.size());
+            _parent.resize (gr.size());
+        }
+        if (source >= gr.size()) return false;
+
+        _reached.mark (source);
+        _distance[source] = W{};
+        _parent[source]   = invalid_node;
+        _heap.push (source, heuristic (source));
+
+        while (!_heap.empty()) {
+            const auto head = _heap.top().id;
+            if (head == target) return true;
+
+            _heap.pop();
+
+            const auto targets = gr.edges (head);
+            const auto weights = gr.weights (head);
+            for (size_t i = 0; i < targets.size(); ++i) {
+                const auto tail     = targets[i];
+                const auto distance = _distance[head] + weights[i];
+
+                if (_reached.mark (tail)) {
+                    _distance[tail] = distance;
+                    _parent[tail]   = head;
+                    _heap.push (tail, distance + heuristic (tail));
+                }
+                else if (distance < _distance[tail] && _heap.contains (tail)) {
+                    _distance[tail] = distance;
+                    _parent[tail]   = head;
+                    _heap.decrease (tail, distance + heuristic (tail));
+                }
+            }
+        }
+        return target == invalid_node;
+    }
+};
+
+}  // namespace gpw::foundation
+
+#endif
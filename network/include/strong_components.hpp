@@ -0,0 +1,337 @@
+//
+// strong_components.hpp
+//
+// Strongly Connected Components of a Directed Graph
+//
+
+#ifndef __GPW_FOUNDATION_STRONG_COMPONENTS__
+#define __GPW_FOUNDATION_STRONG_COMPONENTS__
+
+#include "csr_digraph.hpp"
+#include "node.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+namespace gpw::foundation {
+
+// Partition of the nodes of a graph into strongly connected components:
+// `component[id]` is the component of node `id`, numbered from 0 to
+// `count - 1`, or `invalid_node` if `id` is not in the graph.
+struct strong_components {
+    std::vector<node_id> component;
+    size_t               count = 0;
+};
+
+namespace detail {
+
+// Tarjan's algorithm, with the recursion replaced by an explicit stack of
+// frames so that the depth of the graph is not limited by the call stack.
+// The graph is given by `contains (id)` for the ids below `id_bound`, and by
+// `degree (id)` and `target (id, i)` for the edges leaving a node.
+//
+// A component is numbered when its first node finishes, after every
+// component it reaches, so the numbers are a reverse topological order of
+// the components: an edge between two components goes from the higher
+// number to the lower one.
+template <typename Contains, typename Degree, typename Target>
+strong_components
+tarjan (const size_t id_bound, Contains&& contains, Degree&& degree, Target&& target) {
+    strong_components result{std::vector<node_id> (id_bound, invalid_node), 0};
+    auto&             component = result.component;
+
+    // `index` numbers the nodes in the order they are discovered, and `low`
+    // is the smallest index known to be reachable from the subtree of a
+    // node without leaving its component.  A node is on `stack` from its
+    // discovery until its component is numbered, that is, exactly while it
+    // is discovered and has no component yet.
+    std::vector<node_id> index (id_bound, invalid_node);
+    std::vector<node_id> low (id_bound);
+    std::vector<node_id> stack;
+
+    struct frame {
+        node_id id;
+        size_t  next_edge;
+    };
+    std::vector<frame> frames;
+    node_id            counter = 0;
+
+    const auto discover = [&] (const node_id id) {
+        index[id] = low[id] = counter++;
+        stack.push_back (id);
+        frames.push_back ({id, 0});
+    };
+
+    for (node_id root = 0; root < id_bound; ++root) {
+        if (!contains (root) || index[root] != invalid_node) continue;
+
+        discover (root);
+        while (!frames.empty()) {
+            const auto id = frames.back().id;
+            if (frames.back().next_edge < degree (id)) {
+                const auto tail = target (id, frames.back().next_edge++);
+                if (index[tail] == invalid_node) {
+                    discover (tail);
+                }
+                else if (component[tail] == invalid_node) {
+                    low[id] = std::min (low[id], index[tail]);
+                }
+                continue;
+            }
+
+            frames.pop_back();
+            if (!frames.empty()) {
+                auto& parent_low = low[frames.back().id];
+                parent_low       = std::min (parent_low, low[id]);
+            }
+
+            if (low[id] == index[id]) {
+                const auto number = static_cast<node_id> (result.count++);
+                node_id    member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    component[member] = number;
+                } while (member != id);
+            }
+        }
+    }
+
+    return result;
+}
+
+}  // namespace detail
+
+// Strongly connected components of a frozen graph, numbered in reverse
+// topological order (see `detail::tarjan`).
+template <typename T, typename W>
+strong_components
+strongly_connected_components (const csr_digraph<T, W>& gr) {
+    return detail::tarjan (
+        gr.size(),
+        [] (node_id) { return true; },
+        [&gr] (const node_id id) { return gr.count_connections (id); },
+        [&gr] (const node_id id, const size_t i) { return gr.edges (id)[i]; }
+    );
+}
+
+// Strongly connected components of a frozen graph, split across `threads`
+// threads (0 means as many as the hardware runs concurrently).  The
+// partition is the same as that of `strongly_connected_components`, but the
+// components are numbered in no particular order.
+//
+// Nodes with no incoming or no outgoing edge from the nodes left are first
+// trimmed as components of their own, in parallel passes over all nodes;
+// this disposes of the acyclic parts of the graph.  The rest goes through
+// the forward-backward algorithm (Fleischer, Hendrickson and Pinar, "On
+// Identifying Strongly Connected Components in Parallel", 2000): the nodes
+// reachable both from and to a pivot form its component, and the nodes
+// reachable only from it, only to it, or neither, form three subgraphs that
+// share no component and are split in turn.  Each round splits every
+// subgraph left: large ones one after the other, with each search expanded
+// level by level across the threads, and small ones side by side, one
+// thread each.
+template <typename T, typename W>
+strong_components
+parallel_strongly_connected_components (const csr_digraph<T, W>& gr, const size_t threads = 0) {
+    // Subgraphs and search levels smaller than this are handled by one
+    // thread.
+    constexpr size_t parallel_grain = 4096;
+
+    const auto           n = gr.size();
+    strong_components    result{std::vector<node_id> (n, invalid_node), 0};
+    auto&                component = result.component;
+    std::atomic<node_id> next_component{0};
+
+    const auto component_of = [&component] (const node_id id) {
+        return std::atomic_ref<node_id>{component[id]}.load (std::memory_order_relaxed);
+    };
+
+    // Trimming.  A node whose predecessors (or successors) all have their
+    // component already cannot be on a cycle with the nodes left, whichever
+    // of its neighbors the other threads have just trimmed.  Passes are
+    // repeated while they trim a noticeable share of the nodes left.
+    size_t remaining = n;
+    while (remaining > 0) {
+        std::atomic<size_t> trimmed{0};
+        parallel_for (
+            0,
+            n,
+            [&] (const size_t lo, const size_t hi) {
+                size_t local = 0;
+                for (auto id = static_cast<node_id> (lo); id < hi; ++id) {
+                    if (component[id] != invalid_node) continue;
+
+                    const auto live = [&] (const node_id other) {
+                        return other != id && component_of (other) == invalid_node;
+                    };
+                    if (std::ranges::any_of (gr.in_edges (id), live)
+                        && std::ranges::any_of (gr.edges (id), live)) {
+                        continue;
+                    }
+
+                    std::atomic_ref<node_id>{component[id]}.store (
+                        next_component++, std::memory_order_relaxed
+                    );
+                    ++local;
+                }
+                trimmed += local;
+            },
+            threads
+        );
+
+        remaining -= trimmed;
+        if (trimmed.load() <= remaining / 64) break;
+    }
+
+    // Forward-backward.  Every subgraph has a color, and searches only walk
+    // the nodes of their own color.  A node is claimed by the search that
+    // changes its color, so that searches running side by side never
+    // contend for a node.
+    constexpr node_id    done = invalid_node;
+    std::vector<node_id> color (n, done);
+    std::atomic<node_id> next_color{1};
+
+    struct subgraph {
+        node_id              color;
+        std::vector<node_id> members;
+    };
+    std::vector<subgraph> subgraphs (1);
+    subgraphs[0].color = 0;
+    for (node_id id = 0; id < n; ++id) {
+        if (component[id] == invalid_node) {
+            color[id] = 0;
+            subgraphs[0].members.push_back (id);
+        }
+    }
+    if (subgraphs[0].members.empty()) subgraphs.clear();
+
+    const auto color_of = [&color] (const node_id id) {
+        return std::atomic_ref<node_id>{color[id]}.load (std::memory_order_relaxed);
+    };
+    const auto recolor = [&color] (const node_id id, node_id from, const node_id to) {
+        return std::atomic_ref<node_id>{color[id]}.compare_exchange_strong (
+            from, to, std::memory_order_relaxed
+        );
+    };
+
+    // Visits the nodes reached from `source` through `neighbors (id)` that
+    // `claim (id)` accepts, `source` included.
+    const auto sweep = [&] (const node_id source, auto&& neighbors, auto&& claim, const bool wide) {
+        claim (source);
+        std::vector<node_id> frontier{source};
+        if (!wide) {
+            for (size_t head = 0; head < frontier.size(); ++head) {
+                for (const auto tail : neighbors (frontier[head])) {
+                    if (claim (tail)) frontier.push_back (tail);
+                }
+            }
+            return;
+        }
+
+        std::vector<node_id> next;
+        std::mutex           merge_lock;
+        while (!frontier.empty()) {
+            next.clear();
+            parallel_for (
+                0,
+                frontier.size(),
+                [&] (const size_t lo, const size_t hi) {
+                    std::vector<node_id> local;
+                    for (size_t i = lo; i < hi; ++i) {
+                        for (const auto tail : neighbors (frontier[i])) {
+                            if (claim (tail)) local.push_back (tail);
+                        }
+                    }
+                    std::scoped_lock lock{merge_lock};
+                    next.insert (next.end(), local.begin(), local.end());
+                },
+                frontier.size() < parallel_grain ? 1 : threads
+            );
+            frontier.swap (next);
+        }
+    };
+
+    // Splits `sg`, and appends what is left of it to `pieces`.
+    const auto split = [&] (subgraph& sg, std::vector<subgraph>& pieces, const bool wide) {
+        const auto pivot    = sg.members[sg.members.size() / 2];
+        const auto forward  = next_color++;
+        const auto backward = next_color++;
+        const auto number   = next_component++;
+
+        sweep (
+            pivot,
+            [&gr] (const node_id id) { return gr.edges (id); },
+            [&] (const node_id id) { return recolor (id, sg.color, forward); },
+            wide
+        );
+        sweep (
+            pivot,
+            [&gr] (const node_id id) { return gr.in_edges (id); },
+            [&] (const node_id id) {
+                if (recolor (id, forward, done)) {
+                    component[id] = number;
+                    return true;
+                }
+                return recolor (id, sg.color, backward);
+            },
+            wide
+        );
+
+        subgraph rest{sg.color, {}};
+        subgraph ahead{forward, {}};
+        subgraph behind{backward, {}};
+        for (const auto id : sg.members) {
+            const auto c = color_of (id);
+            if (c == sg.color) rest.members.push_back (id);
+            else if (c == forward) ahead.members.push_back (id);
+            else if (c == backward) behind.members.push_back (id);
+        }
+        for (auto* piece : {&rest, &ahead, &behind}) {
+            if (!piece->members.empty()) pieces.push_back (std::move (*piece));
+        }
+    };
+
+    std::vector<subgraph> pieces;
+    std::mutex            pieces_lock;
+    while (!subgraphs.empty()) {
+        pieces.clear();
+
+        // Large subgraphs first, one at a time.
+        const auto small = std::partition (subgraphs.begin(), subgraphs.end(), [] (const auto& sg) {
+            return sg.members.size() >= parallel_grain;
+        });
+        for (auto sg = subgraphs.begin(); sg != small; ++sg) {
+            split (*sg, pieces, true);
+        }
+
+        const auto first_small = static_cast<size_t> (small - subgraphs.begin());
+        parallel_for (
+            first_small,
+            subgraphs.size(),
+            [&] (const size_t lo, const size_t hi) {
+                std::vector<subgraph> local;
+                for (size_t i = lo; i < hi; ++i) {
+                    split (subgraphs[i], local, false);
+                }
+                std::scoped_lock lock{pieces_lock};
+                std::move (local.begin(), local.end(), std::back_inserter (pieces));
+            },
+            threads
+        );
+
+        subgraphs.swap (pieces);
+    }
+
+    result.count = next_component.load();
+    return result;
+}
+
+}  // namespace gpw::foundation
+
+#endif
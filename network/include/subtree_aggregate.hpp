@@ -0,0 +1,136 @@
+//
+// subtree_aggregate.hpp
+//
+// Aggregates of Node Data over the Subtrees of a Tree
+//
+
+#ifndef __GPW_FOUNDATION_SUBTREE_AGGREGATE__
+#define __GPW_FOUNDATION_SUBTREE_AGGREGATE__
+
+#include "node.hpp"
+#include "segment_tree.hpp"
+#include "tree.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gpw::foundation {
+
+/*******************************************************************************
+ *
+ * @class subtree_aggregate
+ *
+ */
+template <typename T, typename Op = std::plus<T>> class subtree_aggregate {
+    tree<T>* _tree;
+
+    // The nodes are numbered in depth-first pre-order, in which every
+    // subtree is a contiguous run: node `i` is numbered `_entry[i]`, and its
+    // subtree takes the numbers `_entry[i]` .. `_exit[i]`.  `_values` holds
+    // the data of the nodes by number, so that the aggregate of a subtree is
+    // a range query, and a change of data a point update, both O(log N).
+    //
+    // Appending a node renumbers the nodes after it, so the nodes appended
+    // since the last `reindex` are not covered until the next one, and
+    // neither is data changed other than through this aggregate.
+    std::vector<std::uint32_t> _entry;
+    std::vector<std::uint32_t> _exit;
+    segment_tree<T, Op>        _values;
+
+public:
+    // `op` combines the data of two nodes, and `identity` is its neutral
+    // value: `std::plus` and `T{}` give sums, and a maximum with the lowest
+    // value of `T` gives maxima.  Data changed through `set_data` below is
+    // followed at once; data changed otherwise, through `tr` or another
+    // aggregate, only after a `reindex`.
+    explicit subtree_aggregate (tree<T>& tr, Op op = Op{}, T identity = T{})
+        : _tree{&tr}
+        , _values{std::move (op), std::move (identity)} {
+        reindex();
+    }
+
+    // Number of nodes covered, those of the tree at the last `reindex`.
+    size_t
+    size () const {
+        return _entry.size();
+    }
+
+    // Combination of the data in the subtree of `id`, `id` included.  `id`
+    // must refer to a covered node.
+    T
+    value (const node_id id) const {
+        return _values.query (_entry[id], _exit[id] + 1);
+    }
+
+    // Nothing if `label` is not a covered node.
+    std::optional<T>
+    value (const std::string& label) const {
+        const auto found = _tree->id (label);
+        if (!found || *found >= size()) return std::nullopt;
+
+        return value (*found);
+    }
+
+    // Number of nodes in the subtree of `id`, `id` included.
+    size_t
+    size (const node_id id) const {
+        return _exit[id] - _entry[id] + 1;
+    }
+
+    // Sets the data of `id` in the tree, and updates the aggregates of its
+    // ancestors.  Returns false if `id` is not in the tree.
+    bool
+    set_data (const node_id id, const T& data) {
+        if (!_tree->set_data (id, data)) return false;
+
+        if (id < _entry.size()) _values.set (_entry[id], data);
+        return true;
+    }
+
+    bool
+    set_data (const std::string& label, const T& data) {
+        const auto found = _tree->id (label);
+        if (!found) return false;
+
+        return set_data (*found, data);
+    }
+
+    // Covers the nodes appended and the data changed in the tree since the
+    // last time, by numbering all nodes and gathering their data anew in
+    // O(N).  A run of changes is best followed by a single call.
+    void
+    reindex () {
+        const auto n = _tree->size();
+        _entry.resize (n);
+        _exit.resize (n);
+
+        std::vector<T> values;
+        values.reserve (n);
+        struct {
+            subtree_aggregate& index;
+            std::vector<T>&    values;
+
+            void
+            discover (const node<T>& n) {
+                index._entry[n.id()] = static_cast<std::uint32_t> (values.size());
+                values.push_back (*n.data());
+            }
+
+            void
+            finish (const node<T>& n) {
+                index._exit[n.id()] = static_cast<std::uint32_t> (values.size() - 1);
+            }
+        } visitor{*this, values};
+        _tree->depth_first (_tree->root(), visitor);
+
+        _values.assign (std::move (values));
+    }
+};
+
+}  // namespace gpw::foundation
+
+#endif
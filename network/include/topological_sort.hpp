@@ -0,0 +1,151 @@
+//
+// topological_sort.hpp
+//
+// Topological Order and Dependency Levels of a Directed Graph
+//
+
+#ifndef __GPW_FOUNDATION_TOPOLOGICAL_SORT__
+#define __GPW_FOUNDATION_TOPOLOGICAL_SORT__
+
+#include "csr_digraph.hpp"
+#include "node.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace gpw::foundation {
+
+// Nodes of a graph in an order where every edge goes from an earlier node to
+// a later one, grouped into levels: level 0 holds the nodes without incoming
+// edges, and level `k + 1` the nodes whose last predecessor is in level `k`.
+// The nodes of a level do not depend on each other, so a level can be
+// handed out as a batch once the levels before it are done.
+//
+// If the graph has a cycle, `order` holds only the nodes that no cycle
+// leads to, and `cycle` lists the nodes of one cycle, each with an edge to
+// the next and the last with an edge to the first.
+struct topological_order {
+    std::vector<node_id> order;
+    std::vector<size_t>  offsets{0};
+    std::vector<node_id> cycle;
+
+    bool
+    acyclic () const {
+        return cycle.empty();
+    }
+
+    size_t
+    level_count () const {
+        return offsets.size() - 1;
+    }
+
+    std::span<const node_id>
+    level (const size_t i) const {
+        return {order.data() + offsets[i], offsets[i + 1] - offsets[i]};
+    }
+};
+
+namespace detail {
+
+// Kahn's algorithm, level by level.  The graph is given by `contains (id)`
+// for the ids below `id_bound`, by `degree (id)` and `target (id, i)` for the
+// edges leaving a node, and by `in_degree (id)` and `source (id, i)` for the
+// edges entering it.
+template <
+    typename Contains,
+    typename Degree,
+    typename Target,
+    typename InDegree,
+    typename Source>
+topological_order
+kahn (
+    const size_t id_bound,
+    Contains&&   contains,
+    Degree&&     degree,
+    Target&&     target,
+    InDegree&&   in_degree,
+    Source&&     source
+) {
+    topological_order result;
+    auto&             order = result.order;
+
+    // Number of predecessors of each node not placed yet.  A node is placed
+    // when it drops to zero, so the nodes left unplaced are those with a
+    // nonzero count.
+    std::vector<std::uint32_t> pending (id_bound, 0);
+    size_t                     count = 0;
+    for (node_id id = 0; id < id_bound; ++id) {
+        if (!contains (id)) continue;
+
+        ++count;
+        pending[id] = static_cast<std::uint32_t> (in_degree (id));
+        if (pending[id] == 0) order.push_back (id);
+    }
+    order.reserve (count);
+
+    for (size_t begin = 0; begin < order.size();) {
+        const auto end = order.size();
+        result.offsets.push_back (end);
+        for (auto i = begin; i < end; ++i) {
+            const auto head = order[i];
+            for (size_t e = 0; e < degree (head); ++e) {
+                const auto tail = target (head, e);
+                if (--pending[tail] == 0) order.push_back (tail);
+            }
+        }
+        begin = end;
+    }
+
+    if (order.size() == count) return result;
+
+    // Every unplaced node has an unplaced predecessor, so walking back from
+    // one along such predecessors must come back to a node already walked.
+    // The walk from there on, reversed, is a cycle.
+    constexpr auto             unwalked = std::numeric_limits<std::uint32_t>::max();
+    std::vector<std::uint32_t> step (id_bound, unwalked);
+    std::vector<node_id>       walk;
+
+    auto current = static_cast<node_id> (
+        std::find_if (pending.begin(), pending.end(), [] (auto p) { return p != 0; })
+        - pending.begin()
+    );
+    while (step[current] == unwalked) {
+        step[current] = static_cast<std::uint32_t> (walk.size());
+        walk.push_back (current);
+
+        for (size_t e = 0; e < in_degree (current); ++e) {
+            const auto head = source (current, e);
+            if (pending[head] != 0) {
+                current = head;
+                break;
+            }
+        }
+    }
+
+    result.cycle.assign (walk.rbegin(), walk.rend() - step[current]);
+    return result;
+}
+
+}  // namespace detail
+
+// Topological order of a frozen graph, grouped into levels (see
+// `topological_order`).
+template <typename T, typename W>
+topological_order
+topological_sort (const csr_digraph<T, W>& gr) {
+    return detail::kahn (
+        gr.size(),
+        [] (node_id) { return true; },
+        [&gr] (const node_id id) { return gr.count_connections (id); },
+        [&gr] (const node_id id, const size_t i) { return gr.edges (id)[i]; },
+        [&gr] (const node_id id) { return gr.in_degree (id); },
+        [&gr] (const node_id id, const size_t i) { return gr.in_edges (id)[i]; }
+    );
+}
+
+}  // namespace gpw::foundation
+
+#endif
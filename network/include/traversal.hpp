@@ -0,0 +1,284 @@
+//
+// traversal.hpp
+//
+// Iterative Traversals over the Nodes of a Graph or Tree
+//
+
+#ifndef __GPW_FOUNDATION_TRAVERSAL__
+#define __GPW_FOUNDATION_TRAVERSAL__
+
+#include "node.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace gpw::foundation {
+
+// What a traversal does after a visitor has discovered a node.
+enum class visit {
+    proceed,  // follow the edges of the node
+    skip,     // do not follow the edges of the node
+    stop      // end the traversal
+};
+
+namespace detail {
+
+// Result of a `discover` hook, which may also return nothing to proceed.
+template <typename F>
+visit
+result_of (F&& hook) {
+    if constexpr (std::is_void_v<std::invoke_result_t<F>>) {
+        hook();
+        return visit::proceed;
+    }
+    else {
+        return hook();
+    }
+}
+
+// A visitor implements only the hooks it needs, and a missing hook does
+// nothing.  A plain function of a node serves as the `discover` hook.
+template <typename Visitor, typename Node>
+visit
+discover (Visitor& visitor, const Node& n) {
+    if constexpr (requires { visitor.discover (n); }) {
+        return result_of ([&] { return visitor.discover (n); });
+    }
+    else if constexpr (std::is_invocable_v<Visitor&, const Node&>) {
+        return result_of ([&] { return visitor (n); });
+    }
+    else {
+        return visit::proceed;
+    }
+}
+
+// Called for each edge from `head` before following it.  `visit::skip`
+// leaves `tail` alone for now, and `visit::stop` ends the traversal.
+template <typename Visitor, typename Node>
+visit
+examine_edge (Visitor& visitor, const Node& head, const Node& tail) {
+    if constexpr (requires { visitor.examine_edge (head, tail); }) {
+        return result_of ([&] { return visitor.examine_edge (head, tail); });
+    }
+    else {
+        return visit::proceed;
+    }
+}
+
+template <typename Visitor, typename Node>
+void
+finish (Visitor& visitor, const Node& n) {
+    if constexpr (requires { visitor.finish (n); }) visitor.finish (n);
+}
+
+// Nodes visited by the current run of a traversal engine.  A node is visited
+// if its mark equals `_epoch`.  Starting a run only bumps `_epoch`, so that
+// the marks are cleared in O(1) and a reused engine runs without allocating.
+class visit_marks {
+    bool                       _enabled;
+    std::vector<std::uint32_t> _marks;
+    std::uint32_t              _epoch = 0;
+
+public:
+    // A tree reaches each node once, so only graphs need to track visited
+    // nodes.  `id_bound` sizes the marks up front; they grow as needed.
+    explicit visit_marks (const bool enabled, const size_t id_bound)
+        : _enabled{enabled} {
+        if (_enabled) _marks.resize (id_bound, 0);
+    }
+
+    void
+    clear () {
+        if (!_enabled) return;
+
+        if (++_epoch == 0) {
+            std::fill (_marks.begin(), _marks.end(), 0);
+            _epoch = 1;
+        }
+    }
+
+    // Whether `id` has been visited in this run.
+    bool
+    marked (const node_id id) const {
+        return _enabled && id < _marks.size() && _marks[id] == _epoch;
+    }
+
+    // Returns false if `id` has been visited already in this run.
+    bool
+    mark (const node_id id) {
+        if (!_enabled) return true;
+
+        if (id >= _marks.size()) _marks.resize (std::max<size_t> (id + 1, _marks.size() * 2), 0);
+        if (_marks[id] == _epoch) return false;
+
+        _marks[id] = _epoch;
+        return true;
+    }
+};
+
+}  // namespace detail
+
+/*******************************************************************************
+ *
+ * @class depth_first_search
+ *
+ */
+template <typename T, typename W = void> class depth_first_search {
+public:
+    // A node on the current path, and the index of its next edge to follow.
+    struct frame {
+        const node<T, W>* ptr;
+        size_t            next_edge;
+    };
+
+private:
+    // The path from the start node is kept in `_stack` rather than on the
+    // call stack, so the depth of a traversal is bounded by memory only.
+    std::vector<frame> _stack;
+
+    detail::visit_marks _marks;
+
+public:
+    // `track_visits` and `id_bound` configure the visit marks (see
+    // `detail::visit_marks`).
+    explicit depth_first_search (const bool track_visits = true, const size_t id_bound = 0)
+        : _marks{track_visits, id_bound} {}
+
+    // Visits the nodes reachable from `start` in depth-first order.
+    // `visitor.discover (node)` is called in pre-order and `visitor.finish
+    // (node)` in post-order; `finish` is not called for a skipped node.
+    // `visitor.examine_edge (head, tail)` is called before each edge is
+    // followed, whether `tail` has been visited or not.
+    // Returns false if the visitor stopped the traversal.  In that case,
+    // `stack()` still holds the path from `start` to the node that stopped it.
+    template <typename Visitor>
+    bool
+    run (const node<T, W>& start, Visitor&& visitor) {
+        _stack.clear();
+        _marks.clear();
+
+        if (!enter (start, visitor)) return false;
+
+        while (!_stack.empty()) {
+            auto& top = _stack.back();
+            if (top.next_edge < top.ptr->edges().size()) {
+                const auto& head  = *top.ptr;
+                const auto& child = *head.edges()[top.next_edge++];
+                switch (detail::examine_edge (visitor, head, child)) {
+                case visit::proceed:
+                    if (!enter (child, visitor)) return false;
+                    break;
+                case visit::skip: break;
+                case visit::stop: return false;
+                }
+            }
+            else {
+                detail::finish (visitor, *top.ptr);
+                _stack.pop_back();
+            }
+        }
+        return true;
+    }
+
+    // The path from the start node to the node being visited.
+    std::span<const frame>
+    stack () const {
+        return _stack;
+    }
+
+private:
+    // Returns false if the visitor stopped the traversal.
+    template <typename Visitor>
+    bool
+    enter (const node<T, W>& n, Visitor& visitor) {
+        if (!_marks.mark (n.id())) return true;
+
+        _stack.push_back ({&n, 0});
+        switch (detail::discover (visitor, n)) {
+        case visit::proceed: break;
+        case visit::skip: _stack.pop_back(); break;
+        case visit::stop: return false;
+        }
+        return true;
+    }
+};
+
+/*******************************************************************************
+ *
+ * @class breadth_first_search
+ *
+ */
+template <typename T, typename W = void> class breadth_first_search {
+    // Every node enters `_queue` once per run, so that the queue is a plain
+    // vector read from `_head` onwards, and its storage is reused by the next
+    // run.
+    std::vector<const node<T, W>*> _queue;
+    size_t                         _head = 0;
+    detail::visit_marks            _marks;
+
+public:
+    // Same options as `depth_first_search`.
+    explicit breadth_first_search (const bool track_visits = true, const size_t id_bound = 0)
+        : _marks{track_visits, id_bound} {}
+
+    // Visits the nodes reachable from `start` in breadth-first order.
+    // `visitor.discover (node)` is called when a node is first reached, and
+    // a skipped node is not queued.  `visitor.examine_edge (head, tail)` is
+    // called before each edge of a queued node is followed, whether `tail`
+    // has been visited or not, and `visitor.finish (node)` once all of them
+    // have been.
+    // Returns false if the visitor stopped the traversal.
+    template <typename Visitor>
+    bool
+    run (const node<T, W>& start, Visitor&& visitor) {
+        _queue.clear();
+        _head = 0;
+        _marks.clear();
+
+        if (!enter (start, visitor)) return false;
+
+        while (_head < _queue.size()) {
+            const auto& head = *_queue[_head++];
+            for (const auto child : head.edges()) {
+                switch (detail::examine_edge (visitor, head, *child)) {
+                case visit::proceed:
+                    if (!enter (*child, visitor)) return false;
+                    break;
+                case visit::skip: break;
+                case visit::stop: return false;
+                }
+            }
+            detail::finish (visitor, head);
+        }
+        return true;
+    }
+
+    // Whether `id` has been reached by the current run.  Always false when
+    // visits are not tracked.
+    bool
+    visited (const node_id id) const {
+        return _marks.marked (id);
+    }
+
+private:
+    // Returns false if the visitor stopped the traversal.
+    template <typename Visitor>
+    bool
+    enter (const node<T, W>& n, Visitor& visitor) {
+        if (!_marks.mark (n.id())) return true;
+
+        switch (detail::discover (visitor, n)) {
+        case visit::proceed: _queue.push_back (&n); break;
+        case visit::skip: break;
+        case visit::stop: return false;
+        }
+        return true;
+    }
+};
+
+}  // namespace gpw::foundation
+
+#endif
@@ -7,10 +7,20 @@
 #ifndef __GPW_FOUNDATION_TREE__
 #define __GPW_FOUNDATION_TREE__
 
+#include "label_pool.hpp"
 #include "node.hpp"
-
-#include <deque>
+#include "object_pool.hpp"
+#include "traversal.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -27,10 +37,42 @@ template <typename T> class tree {
 
     node_ptr _root;
 
+    // The nodes are created in `_node_pool`, and their edge buffers are
+    // allocated from `_edge_resource`.  Nodes are never removed from a tree,
+    // so a monotonic resource fits: it only hands out memory from large
+    // blocks, and releases them all at once with the tree.
+    std::pmr::monotonic_buffer_resource _edge_resource;
+    object_pool<node<T>>                _node_pool;
+
     // Each node has pointers to other nodes (childrens) connected to it.
     // The connections between the nodes are saved using raw pointers, which
     // do not state the ownership between them.
-    std::list<node<T>> _nodes;
+    // The node with id `i` is `_nodes[i]`, and the root has id 0.
+    std::vector<node_ptr> _nodes;
+
+    // The parent of node `i` is `_parents[i]` (`invalid_node` for the root),
+    // and `_depths[i]` edges separate it from the root.  Both are set once,
+    // when the node is appended, so that paths are walked up from the
+    // destination instead of searched for from the root.
+    std::vector<node_id>       _parents;
+    std::vector<std::uint32_t> _depths;
+
+    // Every label is stored once in `_labels`, and the nodes only view it.
+    // A label is interned only when its node is created, and nodes are never
+    // removed, so the symbol of a label is also the id of its node.
+    label_pool _labels;
+
+    // Depth-first entry and exit numbers of the nodes, indexed by id: the
+    // subtree of node `i` takes the numbers `_entry[i]` .. `_exit[i]`, so an
+    // ancestry test is two comparisons.  Appending a node only marks the
+    // numbering stale; it is redone by the next ancestry query, so a run of
+    // appends pays for one numbering rather than one per node.  Queries run
+    // concurrently on a tree that is not being changed, so the numbering is
+    // redone under `_numbering_mutex`, and `_numbered` publishes it.
+    mutable std::vector<std::uint32_t> _entry;
+    mutable std::vector<std::uint32_t> _exit;
+    mutable std::atomic<bool>          _numbered = false;
+    mutable std::mutex                 _numbering_mutex;
 
 public:
     enum class search_method { depth, breath };
@@ -38,39 +80,155 @@ public:
     tree () = delete;
 
     tree (const std::string& label, const T& data = T()) {
-        _create_node (label, data);
-        _root = &(*_nodes.begin());
+        _root = _create_node (label, data);
+    }
+
+    virtual ~tree () {
+        // Run the destructors only when the data needs it; the memory itself
+        // is released in bulk.
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (auto ptr : _nodes) {
+                _node_pool.destroy (ptr);
+            }
+        }
     }
 
-    virtual ~tree () {}
+    // Prepares the storage for `count` nodes in total.
+    void
+    reserve (const size_t count) {
+        _nodes.reserve (count);
+        _parents.reserve (count);
+        _depths.reserve (count);
+        _labels.reserve (count);
+    }
 
     size_t
     size () const {
         return _nodes.size();
     }
 
-    void
-    append_node (const std::string& parent_label, const std::string& label, const T& data = T()) {
+    node_id
+    root () const {
+        return 0;
+    }
+
+    std::optional<node_id>
+    id (const std::string& label) const {
+        return _labels.find (label);
+    }
+
+    // Nothing if `id` is not in the tree.
+    std::optional<std::string_view>
+    label (const node_id id) const {
+        auto ptr = _find_node (id);
+        if (ptr == nullptr) return std::nullopt;
+
+        return ptr->label();
+    }
+
+    // Nothing if `id` is not in the tree.
+    std::optional<T>
+    data (const node_id id) const {
+        auto ptr = _find_node (id);
+        if (ptr == nullptr) return std::nullopt;
+
+        return ptr->data();
+    }
+
+    std::optional<T>
+    data (const std::string& label) const {
+        const auto found = id (label);
+        if (!found) return std::nullopt;
+
+        return data (*found);
+    }
+
+    // Returns false if `id` is not in the tree.
+    bool
+    set_data (const node_id id, const T& data) {
+        auto ptr = _find_node (id);
+        if (ptr == nullptr) return false;
+
+        ptr->set_data (data);
+        return true;
+    }
+
+    bool
+    set_data (const std::string& label, const T& data) {
+        const auto found = id (label);
+        if (!found) return false;
+
+        return set_data (*found, data);
+    }
+
+    // Returns the id of the new node, or `invalid_node` if the label is
+    // already in the tree or the parent does not exist.
+    node_id
+    append_node (const node_id parent, const std::string& label, const T& data = T()) {
         // If the node already exists in the tree, do nothing.
-        if (_find_node (label)) return;
+        if (_labels.find (label)) return invalid_node;
 
-        auto parent_ptr = _find_node (parent_label);
-        if (parent_ptr == nullptr) return;
+        auto parent_ptr = _find_node (parent);
+        if (parent_ptr == nullptr) return invalid_node;
 
-        auto new_node_ptr = _create_node (label, data);
+        auto new_node_ptr = _create_node (label, data, parent);
         parent_ptr->connect (*new_node_ptr);
+        _numbered.store (false, std::memory_order_relaxed);
+        return new_node_ptr->id();
     }
 
-    std::vector<std::string>
-    path (const std::string& dst, const search_method method = search_method::depth) const {
-        auto dst_ptr = _find_node (dst);
-        if (dst_ptr == nullptr) return {};
+    node_id
+    append_node (const std::string& parent_label, const std::string& label, const T& data = T()) {
+        auto parent = id (parent_label);
+        if (!parent) return invalid_node;
+
+        return append_node (*parent, label, data);
+    }
+
+    // The path from the root to `dst`, both ends included, or an empty path
+    // if `dst` is not in the tree.  It is read up the parent links in
+    // O(depth).
+    std::vector<node_id>
+    path (const node_id dst) const {
+        if (dst >= _nodes.size()) return {};
+
+        std::vector<node_id> path (_depths[dst] + 1);
+        auto                 id = dst;
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            *it = id;
+            id  = _parents[id];
+        }
+        return path;
+    }
 
-        switch (method) {
-        case search_method::depth: return _depth_first_search (dst_ptr);
+    std::vector<std::string>
+    path (const std::string& dst) const {
+        auto dst_id = id (dst);
+        if (!dst_id) return {};
 
-        case search_method::breath: return _breath_first_search (dst_ptr);
+        std::vector<std::string> labels;
+        for (const auto id : path (*dst_id)) {
+            labels.emplace_back (_nodes[id]->label());
         }
+        return labels;
+    }
+
+    // Paths are no longer searched for, so the method makes no difference.
+    [[deprecated ("the search method is ignored; call path (dst)")]]
+    std::vector<node_id>
+    path (const node_id dst, const search_method) const {
+        return path (dst);
+    }
+
+    [[deprecated ("the search method is ignored; call path (dst)")]]
+    std::vector<std::string>
+    path (const std::string& dst, const search_method) const {
+        return path (dst);
+    }
+
+    bool
+    is_ancestor_of (const node_id id, const node_id current_node_id) const {
+        return is_descendent_of (current_node_id, id);
     }
 
     bool
@@ -78,145 +236,166 @@ public:
         return is_descendent_of (current_node_label, label);
     }
 
-    bool
-    is_descendent_of (const std::string& label, const std::string& current_node_label) const {
-        auto current_node_ptr = _find_node (current_node_label);
-        if (current_node_ptr == nullptr) return false;
+    // `invalid_node` for the root or a node not in the tree.
+    node_id
+    parent (const node_id id) const {
+        return id < _nodes.size() ? _parents[id] : invalid_node;
+    }
+
+    // Nothing for the root or a label not in the tree.
+    std::optional<std::string>
+    parent (const std::string& label) const {
+        const auto child = id (label);
+        if (!child || _parents[*child] == invalid_node) return std::nullopt;
 
-        auto descendent_ptr = _find_node (label);
-        if (descendent_ptr == nullptr) return false;
+        return std::string{_nodes[_parents[*child]]->label()};
+    }
 
-        std::list<const_node_ptr> stack;
-        stack.push_back (current_node_ptr);
+    // Number of edges between `id` and the root, or nothing if `id` is not
+    // in the tree.
+    std::optional<size_t>
+    depth (const node_id id) const {
+        if (id >= _nodes.size()) return std::nullopt;
 
-        return _depth_first_search (current_node_ptr, descendent_ptr, stack);
+        return _depths[id];
     }
 
-    std::string
-    description () const {
-        std::stringstream strm;
+    std::optional<size_t>
+    depth (const std::string& label) const {
+        const auto found = id (label);
+        if (!found) return std::nullopt;
 
-        strm << _root->description (true) << '\n';
-        /*for (const auto& child : _root->edges()) {*/
-        /*    strm << child->description() << '\n';*/
-        /*}*/
+        return _depths[*found];
+    }
 
-        return strm.str();
+    // The children of `id`, in the order they were appended.
+    std::vector<node_id>
+    children (const node_id id) const {
+        auto ptr = _find_node (id);
+        if (ptr == nullptr) return {};
+
+        std::vector<node_id> ids;
+        ids.reserve (ptr->count_connections());
+        for (const auto& child : ptr->edges()) {
+            ids.push_back (child->id());
+        }
+        return ids;
     }
 
-private:
-    node_ptr
-    _create_node (const std::string& label, const T& data) {
-        _nodes.emplace_back (node<T>{label, data});
-        return &_nodes.back();
+    std::vector<std::string>
+    children (const std::string& label) const {
+        const auto found = id (label);
+        if (!found) return {};
+
+        std::vector<std::string> labels;
+        for (const auto child : children (*found)) {
+            labels.emplace_back (_nodes[child]->label());
+        }
+        return labels;
     }
 
-    node_ptr
-    _find_node (const std::string& label) {
-        return const_cast<node_ptr> (static_cast<const tree&> (*this)._find_node (label));
+    // A node is its own descendent.  The first query after an append
+    // renumbers the tree in O(N), and later ones take O(1).
+    bool
+    is_descendent_of (const node_id id, const node_id current_node_id) const {
+        if (id >= _nodes.size() || current_node_id >= _nodes.size()) return false;
+
+        _number();
+        return _entry[current_node_id] <= _entry[id] && _exit[id] <= _exit[current_node_id];
     }
 
-    const_node_ptr
-    _find_node (const std::string& label) const {
-        auto iter = std::find_if (_nodes.begin(), _nodes.end(), [&label] (auto& node) {
-            return node.label() == label;
-        });
+    bool
+    is_descendent_of (const std::string& label, const std::string& current_node_label) const {
+        auto current_node_id = id (current_node_label);
+        auto descendent_id   = id (label);
 
-        if (iter == _nodes.end()) return nullptr;
+        if (!current_node_id || !descendent_id) return false;
 
-        return &(*iter);
+        return is_descendent_of (*descendent_id, *current_node_id);
     }
 
-    std::vector<std::string>
-    _depth_first_search (const_node_ptr dst) const {
-        std::vector<std::string>  path;
-        std::list<const_node_ptr> stack;
-        stack.push_back (_root);
-
-        if (_depth_first_search (_root, dst, stack)) {
-            std::transform (
-                stack.cbegin(),
-                stack.cend(),
-                std::back_inserter (path),
-                [] (const auto& node) { return node->label(); }
-            );
-            return path;
-        }
-        // The leaf node is not found in this tree.
-        return {};
+    // Calls `discover (node)` of `visitor` in pre-order and `finish (node)` in
+    // post-order, for the subtree rooted at `start` (see `depth_first_search`).
+    // Returns false if the visitor stopped the traversal or `start` is not in
+    // the tree.  Passing an `engine` reuses its storage across traversals.
+    template <typename Visitor>
+    bool
+    depth_first (depth_first_search<T>& engine, const node_id start, Visitor&& visitor) const {
+        auto start_ptr = _find_node (start);
+        if (start_ptr == nullptr) return false;
+
+        return engine.run (*start_ptr, std::forward<Visitor> (visitor));
     }
 
+    template <typename Visitor>
     bool
-    _depth_first_search (const_node_ptr root, const_node_ptr dst, std::list<const_node_ptr>& stack)
-        const {
-        if (root == dst) return true;
+    depth_first (const node_id start, Visitor&& visitor) const {
+        depth_first_search<T> engine{false};
+        return depth_first (engine, start, std::forward<Visitor> (visitor));
+    }
 
-        for (const auto& child : root->edges()) {
-            stack.push_back (child);
-            if (_depth_first_search (child, dst, stack)) return true;
+    std::string
+    description () const {
+        std::stringstream strm;
 
-            stack.pop_back();
-        }
+        depth_first (root(), [&strm] (const node<T>& n) { strm << n.description(); });
+        strm << '\n';
 
-        return false;
+        return strm.str();
     }
 
-    using backtrackable = std::pair<node_ptr, node_ptr>;
+private:
+    node_ptr
+    _create_node (const std::string& label, const T& data, const node_id parent = invalid_node) {
+        const auto id = _labels.intern (label);
+        _parents.push_back (parent);
+        _depths.push_back (parent == invalid_node ? 0 : _depths[parent] + 1);
+        _nodes.push_back (_node_pool.create (_labels.view (id), data, id, &_edge_resource));
+        return _nodes.back();
+    }
 
-    std::vector<std::string>
-    _breath_first_search (const_node_ptr dst) const {
-        std::vector<std::string> path;
-        std::deque<node_ptr>     queue;
-        std::list<backtrackable> node_pairs;
-
-        queue.push_front (_root);
-        // Root node does not have its parent.
-        node_pairs.push_back (std::make_pair (_root, nullptr));
-
-        if (_breath_first_search (dst, queue, node_pairs)) {
-            // Backtrack and build path
-            std::vector<std::string> backtrack;
-
-            const_node_ptr current = dst;
-            while (current != nullptr) {
-                backtrack.push_back (current->label());
-                auto backstep = std::find_if (
-                    node_pairs.cbegin(),
-                    node_pairs.cend(),
-                    [&current] (const auto& node_pair) {
-                        return std::get<0> (node_pair) == current;
-                    }
-                );
-
-                current = std::get<1> (*backstep);
-            }
+    node_ptr
+    _find_node (const node_id id) {
+        return const_cast<node_ptr> (static_cast<const tree&> (*this)._find_node (id));
+    }
 
-            std::copy (backtrack.crbegin(), backtrack.crend(), std::back_inserter (path));
-            return path;
-        }
-        return {};
+    const_node_ptr
+    _find_node (const node_id id) const {
+        if (id >= _nodes.size()) return nullptr;
+
+        return _nodes[id];
     }
 
-    bool
-    _breath_first_search (
-        const_node_ptr            dst,
-        std::deque<node_ptr>&     queue,
-        std::list<backtrackable>& node_pairs
-    ) const {
-        auto current = queue.front();
+    // Recomputes `_entry` and `_exit` if nodes were appended since the last
+    // numbering.  Concurrent callers wait for the one that renumbers.
+    void
+    _number () const {
+        if (_numbered.load (std::memory_order_acquire)) return;
 
-        if (current == dst) return true;
+        std::lock_guard lock{_numbering_mutex};
+        if (_numbered.load (std::memory_order_relaxed)) return;
 
-        queue.pop_front();
+        _entry.resize (_nodes.size());
+        _exit.resize (_nodes.size());
 
-        for (const auto& child : current->edges()) {
-            node_pairs.push_back (std::make_pair (child, current));
-            queue.push_back (child);
-        }
+        std::uint32_t counter = 0;
+        struct {
+            const tree&    tr;
+            std::uint32_t& counter;
 
-        if (queue.size() == 0) return false;
+            void
+            discover (const node<T>& n) {
+                tr._entry[n.id()] = counter++;
+            }
+
+            void
+            finish (const node<T>& n) {
+                tr._exit[n.id()] = counter - 1;
+            }
+        } visitor{*this, counter};
+        depth_first (root(), visitor);
 
-        return _breath_first_search (dst, queue, node_pairs);
+        _numbered.store (true, std::memory_order_release);
     }
 };
 
@@ -0,0 +1,353 @@
+//
+// work_stealing_pool.hpp
+//
+// Pool of Threads Sharing Jobs by Work Stealing
+//
+
+#ifndef __GPW_FOUNDATION_WORK_STEALING_POOL__
+#define __GPW_FOUNDATION_WORK_STEALING_POOL__
+
+#include "node.hpp"
+#include "parallel.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace gpw::foundation {
+
+namespace detail {
+
+// Double-ended queue of jobs with a single owner, which pushes and takes at
+// the bottom, while any other thread may steal from the top (Chase and Lev,
+// "Dynamic Circular Work-Stealing Deque", 2005, in the formulation of Lê,
+// Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing for
+// Weak Memory Models", 2013).  Only the last job of the queue is contended
+// for, with a compare-and-swap on `_top`; everything else takes no lock and
+// no read-modify-write.
+class job_deque {
+    // Ring of `mask + 1` slots, a power of two.  The slots are atomic so that
+    // a thief may read a slot that the owner is about to reuse; it then fails
+    // its compare-and-swap and drops the value.
+    struct ring {
+        size_t                                  mask;
+        std::unique_ptr<std::atomic<node_id>[]> slots;
+
+        explicit ring (const size_t capacity)
+            : mask{capacity - 1}
+            , slots{new std::atomic<node_id>[capacity]} {}
+
+        node_id
+        get (const std::int64_t i) const {
+            return slots[static_cast<size_t> (i) & mask].load (std::memory_order_relaxed);
+        }
+
+        void
+        put (const std::int64_t i, const node_id job) {
+            slots[static_cast<size_t> (i) & mask].store (job, std::memory_order_relaxed);
+        }
+    };
+
+    alignas (64) std::atomic<std::int64_t> _top{0};
+    alignas (64) std::atomic<std::int64_t> _bottom{0};
+    std::atomic<ring*> _ring;
+
+    // Rings replaced by larger ones.  A thief may still read a replaced
+    // ring, so they are freed only by `reclaim`, once no thread steals.
+    std::vector<std::unique_ptr<ring>> _rings;
+
+public:
+    explicit job_deque (const size_t capacity = 256) {
+        _rings.push_back (std::make_unique<ring> (capacity));
+        _ring.store (_rings.back().get(), std::memory_order_relaxed);
+    }
+
+    // Owner only.
+    void
+    push (const node_id job) {
+        const auto b = _bottom.load (std::memory_order_relaxed);
+        const auto t = _top.load (std::memory_order_acquire);
+        auto*      r = _ring.load (std::memory_order_relaxed);
+        if (b - t > static_cast<std::int64_t> (r->mask)) r = grow (r, t, b);
+
+        r->put (b, job);
+        _bottom.store (b + 1, std::memory_order_release);
+    }
+
+    // Owner only.  Takes the job pushed last.
+    std::optional<node_id>
+    take () {
+        const auto b = _bottom.load (std::memory_order_relaxed) - 1;
+        auto*      r = _ring.load (std::memory_order_relaxed);
+        _bottom.store (b, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        auto t = _top.load (std::memory_order_relaxed);
+
+        std::optional<node_id> job;
+        if (t <= b) {
+            job = r->get (b);
+            if (t == b) {
+                // The last job: thieves may be after it too.
+                if (!_top.compare_exchange_strong (
+                        t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+                    )) {
+                    job.reset();
+                }
+                _bottom.store (b + 1, std::memory_order_relaxed);
+            }
+        }
+        else {
+            _bottom.store (b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    // Any thread.  Takes the job pushed first, or nothing if the queue is
+    // empty or another thread took that job first.
+    std::optional<node_id>
+    steal () {
+        auto t = _top.load (std::memory_order_acquire);
+        std::atomic_thread_fence (std::memory_order_seq_cst);
+        const auto b = _bottom.load (std::memory_order_acquire);
+        if (t >= b) return std::nullopt;
+
+        const auto job = _ring.load (std::memory_order_acquire)->get (t);
+        if (!_top.compare_exchange_strong (
+                t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+            )) {
+            return std::nullopt;
+        }
+        return job;
+    }
+
+    // Frees the replaced rings.  No thread may be stealing.
+    void
+    reclaim () {
+        auto* current = _ring.load (std::memory_order_relaxed);
+        std::erase_if (_rings, [current] (const auto& r) { return r.get() != current; });
+    }
+
+private:
+    ring*
+    grow (const ring* r, const std::int64_t t, const std::int64_t b) {
+        _rings.push_back (std::make_unique<ring> (2 * (r->mask + 1)));
+        auto* bigger = _rings.back().get();
+        for (auto i = t; i < b; ++i) {
+            bigger->put (i, r->get (i));
+        }
+        _ring.store (bigger, std::memory_order_release);
+        return bigger;
+    }
+};
+
+}  // namespace detail
+
+/*******************************************************************************
+ *
+ * @class work_stealing_pool
+ *
+ */
+class work_stealing_pool {
+public:
+    // Handed to a job so that it can queue more jobs, on the queue of the
+    // thread running it.
+    class spawner {
+        work_stealing_pool& _pool;
+        size_t              _worker;
+
+        friend class work_stealing_pool;
+
+        spawner (work_stealing_pool& pool, const size_t worker)
+            : _pool{pool}
+            , _worker{worker} {}
+
+    public:
+        void
+        spawn (const node_id job) {
+            _pool._outstanding.fetch_add (1, std::memory_order_relaxed);
+            _pool._workers[_worker]->jobs.push (job);
+        }
+
+        // Index of the thread running the job, from 0 (the thread that called
+        // `run`) to `size () - 1`.
+        size_t
+        worker () const {
+            return _worker;
+        }
+    };
+
+private:
+    struct worker {
+        detail::job_deque jobs;
+        std::minstd_rand  random;
+    };
+
+    // `_workers[0]` is the thread that calls `run`, and `_workers[i]` for
+    // `i > 0` is `_threads[i - 1]`.  Each one owns its queue, takes jobs
+    // from it last-in first-out, which keeps the data of a job and the jobs
+    // it spawns in cache, and steals from the others, at random, first-in
+    // first-out, when its queue runs dry.
+    std::vector<std::unique_ptr<worker>> _workers;
+    std::vector<std::jthread>            _threads;
+
+    // Jobs queued or running.  The batch is over when it drops to zero:
+    // a job spawns its children before it is counted out.
+    std::atomic<size_t> _outstanding{0};
+
+    // Batch handed to the threads.  The lock is taken only to start and end
+    // a batch, never per job.
+    std::mutex              _lock;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    std::uint64_t           _batch    = 0;
+    size_t                  _running  = 0;
+    bool                    _stopping = false;
+
+    // `fn` of the current batch, and how to call it.
+    void (*_handler) (void*, node_id, spawner&) = nullptr;
+    void* _context                              = nullptr;
+
+public:
+    // `threads` threads in all, the calling thread of `run` included (0
+    // means as many as the hardware runs concurrently).
+    explicit work_stealing_pool (const size_t threads = 0) {
+        const auto count = thread_count (threads);
+        for (size_t i = 0; i < count; ++i) {
+            _workers.push_back (std::make_unique<worker>());
+            _workers.back()->random.seed (static_cast<unsigned> (i + 1));
+        }
+        for (size_t i = 1; i < count; ++i) {
+            _threads.emplace_back ([this, i] { serve (i); });
+        }
+    }
+
+    work_stealing_pool (const work_stealing_pool&) = delete;
+    work_stealing_pool&
+    operator= (const work_stealing_pool&) = delete;
+
+    ~work_stealing_pool () {
+        {
+            std::scoped_lock lock{_lock};
+            _stopping = true;
+        }
+        _wake.notify_all();
+
+        // Join before the members the threads use are destroyed.
+        _threads.clear();
+    }
+
+    size_t
+    size () const {
+        return _workers.size();
+    }
+
+    // Calls `fn (job, spawner)` for every job of `seeds`, and for every job
+    // spawned through `spawner` by the calls, across the threads of the
+    // pool.  Returns once all of them have returned.  `fn` must not throw.
+    // Batches do not overlap: `run` must not be called again until it
+    // returns.
+    template <typename F>
+    void
+    run (std::span<const node_id> seeds, F&& fn) {
+        if (seeds.empty()) return;
+
+        _handler = [] (void* context, const node_id job, spawner& sp) {
+            (*static_cast<std::remove_reference_t<F>*> (context)) (job, sp);
+        };
+        _context = const_cast<void*> (static_cast<const void*> (&fn));
+
+        // The seeds are dealt out round robin before the threads wake up, so
+        // the owners are not yet using their queues.
+        _outstanding.store (seeds.size(), std::memory_order_relaxed);
+        for (size_t i = 0; i < seeds.size(); ++i) {
+            _workers[i % _workers.size()]->jobs.push (seeds[i]);
+        }
+
+        {
+            std::scoped_lock lock{_lock};
+            ++_batch;
+            _running = _threads.size();
+        }
+        _wake.notify_all();
+
+        work (0);
+
+        // `fn` must outlive every call, so wait until the other threads are
+        // out of the batch too.
+        std::unique_lock lock{_lock};
+        _done.wait (lock, [this] { return _running == 0; });
+        for (auto& w : _workers) {
+            w->jobs.reclaim();
+        }
+    }
+
+private:
+    // Loop of the threads but the caller's: one batch after the other.
+    void
+    serve (const size_t index) {
+        std::uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock lock{_lock};
+                _wake.wait (lock, [&] { return _stopping || _batch != seen; });
+                if (_stopping) return;
+                seen = _batch;
+            }
+
+            work (index);
+
+            std::scoped_lock lock{_lock};
+            if (--_running == 0) _done.notify_one();
+        }
+    }
+
+    // Runs jobs until none is left anywhere.
+    void
+    work (const size_t index) {
+        auto&   self = *_workers[index];
+        spawner sp{*this, index};
+        size_t  idle = 0;
+        while (_outstanding.load (std::memory_order_acquire) != 0) {
+            auto job = self.jobs.take();
+            if (!job) job = steal (index);
+            if (!job) {
+                // Jobs are still running elsewhere and may spawn more.
+                if (++idle > 64) std::this_thread::yield();
+                continue;
+            }
+
+            idle = 0;
+            _handler (_context, *job, sp);
+            _outstanding.fetch_sub (1, std::memory_order_acq_rel);
+        }
+    }
+
+    // One pass over the other queues, from a random one.
+    std::optional<node_id>
+    steal (const size_t index) {
+        const auto count = _workers.size();
+        if (count == 1) return std::nullopt;
+
+        auto&      self  = *_workers[index];
+        const auto first = self.random() % count;
+        for (size_t k = 0; k < count; ++k) {
+            const auto victim = (first + k) % count;
+            if (victim == index) continue;
+
+            if (auto job = _workers[victim]->jobs.steal()) return job;
+        }
+        return std::nullopt;
+    }
+};
+
+}  // namespace gpw::foundation
+
+#endif
@@ -1,8 +1,32 @@
+#include "centrality.hpp"
+#include "d_ary_heap.hpp"
+#include "dag_executor.hpp"
 #include "digraph.hpp"
+#include "label_pool.hpp"
+#include "lca_index.hpp"
+#include "object_pool.hpp"
+#include "page_rank.hpp"
+#include "parallel_bfs.hpp"
+#include "path_aggregate.hpp"
+#include "segment_tree.hpp"
+#include "shortest_path.hpp"
+#include "strong_components.hpp"
+#include "subtree_aggregate.hpp"
+#include "topological_sort.hpp"
+#include "traversal.hpp"
 #include "tree.hpp"
+#include "work_stealing_pool.hpp"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+
 using namespace gpw::foundation;
 
 TEST (Node, ConnectionDisconnection) {
@@ -71,6 +95,174 @@ TEST (Node, ConnectionDisconnectionStringData) {
     EXPECT_EQ (a.count_connections(), 1);
 }
 
+TEST (Node, HighDegree) {
+    // Enough neighbors for the edges to be indexed by hash.
+    // Nodes only view their labels, so the strings must outlive them.
+    std::vector<std::string> labels;
+    std::vector<node<int>>   leaves;
+    for (int i = 0; i < 100; ++i) {
+        labels.push_back (std::to_string (i));
+    }
+    for (int i = 0; i < 100; ++i) {
+        leaves.emplace_back (labels[i], i);
+    }
+
+    node<int> hub ("hub");
+    for (auto& leaf : leaves) {
+        hub.connect (leaf);
+    }
+    EXPECT_EQ (hub.count_connections(), 100);
+
+    // Duplicate connection: should be rejected
+    hub.connect (leaves[42]);
+    EXPECT_EQ (hub.count_connections(), 100);
+
+    hub.disconnect (leaves[0]);
+    hub.disconnect (leaves[99]);
+    hub.disconnect ("42");
+    EXPECT_EQ (hub.count_connections(), 97);
+
+    EXPECT_FALSE (hub.is_connected (leaves[0]));
+    EXPECT_FALSE (hub.is_connected (leaves[42]));
+    EXPECT_FALSE (hub.is_connected (leaves[99]));
+    for (int i = 1; i < 99; ++i) {
+        if (i == 42) continue;
+        EXPECT_TRUE (hub.is_connected (leaves[i]));
+    }
+
+    hub.connect (leaves[42]);
+    EXPECT_TRUE (hub.is_connected (leaves[42]));
+    EXPECT_EQ (hub.count_connections(), 98);
+}
+
+TEST (Node, IncomingEdges) {
+    node<int> a ("a");
+    node<int> b ("b");
+    node<int> c ("c");
+
+    a.connect (b);
+    c.connect (b);
+    b.connect (b);
+    EXPECT_EQ (b.in_degree(), 3);
+    EXPECT_EQ (a.in_degree(), 0);
+    EXPECT_TRUE (std::ranges::find (b.in_edges(), &a) != b.in_edges().end());
+
+    a.disconnect (b);
+    EXPECT_EQ (b.in_degree(), 2);
+
+    c.disconnect ("b");
+    EXPECT_EQ (b.in_degree(), 1);
+
+    a.connect (b);
+    b.connect (c);
+    b.isolate();
+    EXPECT_EQ (b.in_degree(), 0);
+    EXPECT_EQ (b.count_connections(), 0);
+    EXPECT_EQ (a.count_connections(), 0);
+    EXPECT_EQ (c.in_degree(), 0);
+}
+
+TEST (LabelPool, Interning) {
+    label_pool pool;
+    EXPECT_EQ (pool.size(), 0);
+
+    auto a = pool.intern ("alpha");
+    auto b = pool.intern (std::string{"beta"});
+    EXPECT_NE (a, b);
+    EXPECT_EQ (pool.size(), 2);
+
+    // The same label is stored only once
+    std::string alpha{"alpha"};
+    EXPECT_EQ (pool.intern (alpha), a);
+    EXPECT_EQ (pool.size(), 2);
+    EXPECT_EQ (pool.view (a), "alpha");
+    EXPECT_NE (pool.view (a).data(), alpha.data());
+
+    EXPECT_EQ (pool.find ("beta"), b);
+    EXPECT_FALSE (pool.find ("gamma").has_value());
+
+    // The views stay valid while the pool grows, including long labels
+    std::string_view first = pool.view (a);
+    std::string      long_label (100000, 'x');
+    for (int i = 0; i < 10000; ++i) {
+        pool.intern ("label-" + std::to_string (i));
+    }
+    auto l = pool.intern (long_label);
+    EXPECT_EQ (pool.view (l), long_label);
+    EXPECT_EQ (pool.view (a).data(), first.data());
+    EXPECT_EQ (pool.view (a), "alpha");
+    EXPECT_EQ (pool.find ("label-9999"), pool.intern ("label-9999"));
+
+    // A copy keeps the symbols, with views into its own storage
+    label_pool copy{pool};
+    EXPECT_EQ (copy.size(), pool.size());
+    EXPECT_EQ (copy.bytes(), pool.bytes());
+    EXPECT_EQ (copy.find ("alpha"), a);
+    EXPECT_EQ (copy.view (l), long_label);
+    EXPECT_NE (copy.view (a).data(), pool.view (a).data());
+    copy = label_pool{};
+    EXPECT_EQ (copy.size(), 0);
+    copy = pool;
+    EXPECT_EQ (copy.find ("label-42"), pool.find ("label-42"));
+}
+
+TEST (ObjectPool, Recycling) {
+    object_pool<std::string, 4> pool;
+    EXPECT_EQ (pool.chunk_count(), 0);
+
+    std::vector<std::string*> objects;
+    for (int i = 0; i < 6; ++i) {
+        objects.push_back (pool.create (std::to_string (i)));
+    }
+    EXPECT_EQ (pool.chunk_count(), 2);
+    EXPECT_EQ (*objects[5], "5");
+
+    // A destroyed slot is used again before a new chunk is taken
+    pool.destroy (objects[1]);
+    auto recycled = pool.create ("x");
+    EXPECT_EQ (recycled, objects[1]);
+    EXPECT_EQ (*recycled, "x");
+
+    pool.create ("6");
+    pool.create ("7");
+    EXPECT_EQ (pool.chunk_count(), 2);
+    pool.create ("8");
+    EXPECT_EQ (pool.chunk_count(), 3);
+
+    for (auto ptr : objects) {
+        pool.destroy (ptr);
+    }
+}
+
+TEST (DAryHeap, Ordering) {
+    d_ary_heap<int> heap;
+
+    // Keys 100, 99, ..., 1 for ids 0 .. 99, then every third one lowered.
+    for (node_id id = 0; id < 100; ++id) {
+        heap.push (id, 100 - static_cast<int> (id));
+    }
+    for (node_id id = 0; id < 100; id += 3) {
+        heap.decrease (id, -static_cast<int> (id));
+    }
+    EXPECT_EQ (heap.size(), 100);
+    EXPECT_TRUE (heap.contains (42));
+
+    int previous = std::numeric_limits<int>::min();
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_LE (previous, heap.top().key);
+        previous = heap.top().key;
+        heap.pop();
+    }
+    EXPECT_EQ (heap.top().key, 26);
+
+    // A cleared heap can take the same ids again.
+    heap.clear();
+    EXPECT_TRUE (heap.empty());
+    EXPECT_FALSE (heap.contains (42));
+    heap.push (42, 7);
+    EXPECT_EQ (heap.top().id, 42);
+}
+
 TEST (Digraph, NodeAdditionRemoval) {
     digraph<int> gr;
     EXPECT_EQ (gr.size(), 0);
@@ -181,6 +373,1024 @@ TEST (Digraph, NodeConnection) {
     EXPECT_EQ (gr.count_connections(), 23);
 }
 
+TEST (Digraph, NodeRecreation) {
+    digraph<int> gr;
+
+    gr.create_node ("A");
+    gr.create_node ("B");
+    gr.connect_node ("A", "B");
+    gr.connect_node ("B", "A");
+    EXPECT_EQ (gr.count_connections(), 2);
+
+    gr.create_node ("C");
+    gr.connect_node ("C", "B");
+    EXPECT_EQ (gr.in_degree ("B"), 2);
+
+    // Removal drops the connections to and from the node
+    gr.remove_node ("B");
+    EXPECT_EQ (gr.size(), 2);
+    EXPECT_EQ (gr.count_connections(), 0);
+    EXPECT_EQ (gr.in_degree ("A"), 0);
+    EXPECT_FALSE (gr.is_connected ("A", "B"));
+
+    // A removed label can be used again
+    gr.create_node ("B");
+    EXPECT_EQ (gr.size(), 3);
+    EXPECT_EQ (gr.in_degree ("B"), 0);
+    EXPECT_FALSE (gr.is_connected ("A", "B"));
+
+    gr.connect_node ("A", "B");
+    EXPECT_TRUE (gr.is_connected ("A", "B"));
+    EXPECT_EQ (gr.count_connections(), 1);
+}
+
+TEST (Digraph, Freeze) {
+    digraph<int> gr;
+
+    gr.create_node ("A", 1);
+    gr.create_node ("B", 2);
+    gr.create_node ("C", 3);
+    gr.create_node ("D", 4);
+
+    gr.connect_node ("A", "D");
+    gr.connect_node ("A", "B");
+    gr.connect_node ("B", "C");
+    gr.connect_node ("C", "A");
+    gr.connect_node ("C", "C");
+
+    auto csr = gr.freeze();
+    EXPECT_EQ (csr.size(), 4);
+    EXPECT_EQ (csr.count_connections(), 5);
+
+    EXPECT_TRUE (csr.is_connected ("A", "D"));
+    EXPECT_TRUE (csr.is_connected ("A", "B"));
+    EXPECT_TRUE (csr.is_connected ("B", "C"));
+    EXPECT_TRUE (csr.is_connected ("C", "A"));
+    EXPECT_TRUE (csr.is_connected ("C", "C"));
+    EXPECT_FALSE (csr.is_connected ("D", "A"));
+    EXPECT_FALSE (csr.is_connected ("A", "Z"));
+
+    auto a = csr.id ("A");
+    ASSERT_TRUE (a.has_value());
+    EXPECT_EQ (csr.label (*a), "A");
+    EXPECT_EQ (csr.data (*a), 1);
+    EXPECT_EQ (csr.count_connections (*a), 2);
+
+    // Edges of a node are sorted by id
+    auto edges = csr.edges (*a);
+    ASSERT_EQ (edges.size(), 2);
+    EXPECT_EQ (csr.label (edges[0]), "B");
+    EXPECT_EQ (csr.label (edges[1]), "D");
+
+    EXPECT_FALSE (csr.id ("Z").has_value());
+
+    // Incoming edges are gathered too, sorted by id
+    auto c      = csr.id ("C");
+    auto in_c   = csr.in_edges (*c);
+    auto expect = std::vector<node_id>{*csr.id ("B"), *c};
+    EXPECT_EQ (std::vector<node_id> (in_c.begin(), in_c.end()), expect);
+    EXPECT_EQ (csr.in_degree (*csr.id ("D")), 1);
+
+    // The snapshot does not follow later changes
+    gr.remove_node ("D");
+    EXPECT_TRUE (csr.is_connected ("A", "D"));
+
+    // A copy owns its labels, and outlives the original
+    std::optional<csr_digraph<int>> original{csr};
+    auto                            copy = *original;
+    original.reset();
+    EXPECT_EQ (copy.size(), 4);
+    EXPECT_EQ (copy.label (*copy.id ("C")), "C");
+    EXPECT_TRUE (copy.is_connected ("C", "A"));
+    copy = csr;
+    EXPECT_EQ (copy.id ("D"), csr.id ("D"));
+}
+
+TEST (Digraph, Handles) {
+    digraph<int> gr;
+
+    auto a = gr.create_node ("A");
+    auto b = gr.create_node ("B");
+    auto c = gr.create_node ("C");
+    EXPECT_NE (a, b);
+    EXPECT_NE (b, c);
+
+    // Duplicate label: the existing node is returned
+    EXPECT_EQ (gr.create_node ("B"), b);
+    EXPECT_EQ (gr.size(), 3);
+
+    EXPECT_EQ (gr.id ("C"), c);
+    EXPECT_EQ (gr.label (c), "C");
+    EXPECT_FALSE (gr.id ("Z").has_value());
+
+    gr.connect_node (a, b);
+    gr.connect_node (b, c);
+    EXPECT_TRUE (gr.is_connected (a, b));
+    EXPECT_TRUE (gr.is_connected ("B", "C"));
+    EXPECT_FALSE (gr.is_connected (c, a));
+    EXPECT_EQ (gr.in_degree (c), 1);
+
+    gr.remove_node (b);
+    EXPECT_FALSE (gr.contains (b));
+    EXPECT_FALSE (gr.is_connected (a, b));
+    EXPECT_EQ (gr.in_degree (c), 0);
+    EXPECT_EQ (gr.size(), 2);
+
+    // Operations on a removed or unknown id are ignored
+    gr.connect_node (a, b);
+    gr.connect_node (a, 100);
+    gr.remove_node (b);
+    EXPECT_EQ (gr.count_connections(), 0);
+    EXPECT_EQ (gr.size(), 2);
+    EXPECT_EQ (gr.label (b), std::nullopt);
+    EXPECT_EQ (gr.label (100), std::nullopt);
+
+    // The freed id is handed out again
+    auto d = gr.create_node ("D");
+    EXPECT_EQ (d, b);
+    EXPECT_EQ (gr.label (d), "D");
+    EXPECT_LE (gr.id_bound(), 3);
+}
+
+TEST (Digraph, DepthFirst) {
+    // a -> b -> d
+    // |    ^    |
+    // v    |    v
+    // c ---'    e -> a
+    digraph<int> gr;
+    for (const auto* label : {"a", "b", "c", "d", "e"}) {
+        gr.create_node (label);
+    }
+    gr.connect_node ("a", "b");
+    gr.connect_node ("a", "c");
+    gr.connect_node ("c", "b");
+    gr.connect_node ("b", "d");
+    gr.connect_node ("d", "e");
+    gr.connect_node ("e", "a");
+
+    struct recorder {
+        std::string pre;
+        std::string post;
+
+        void
+        discover (const node<int>& n) {
+            pre += n.label();
+        }
+
+        void
+        finish (const node<int>& n) {
+            post += n.label();
+        }
+    };
+
+    // Each node is visited once despite the cycle.
+    recorder order;
+    EXPECT_TRUE (gr.depth_first (*gr.id ("a"), order));
+    EXPECT_EQ (order.pre, "abdec");
+    EXPECT_EQ (order.post, "edbca");
+
+    // Skipping a node leaves its edges alone, and a reused engine starts
+    // afresh.
+    depth_first_search<int> engine;
+    std::string             visited;
+    EXPECT_TRUE (gr.depth_first (engine, *gr.id ("a"), [&] (const node<int>& n) {
+        visited += n.label();
+        return n.label() == "b" ? visit::skip : visit::proceed;
+    }));
+    EXPECT_EQ (visited, "abc");
+
+    // Stopping keeps the path to the node that stopped the traversal.
+    EXPECT_FALSE (gr.depth_first (engine, *gr.id ("c"), [] (const node<int>& n) {
+        return n.label() == "e" ? visit::stop : visit::proceed;
+    }));
+    std::string path;
+    for (const auto& frame : engine.stack()) {
+        path += frame.ptr->label();
+    }
+    EXPECT_EQ (path, "cbde");
+
+    EXPECT_FALSE (gr.depth_first (invalid_node, order));
+}
+
+TEST (Digraph, BreadthFirst) {
+    // a -> b -> d -> f
+    // |         ^
+    // v         |
+    // c -> e ---'    g
+    digraph<int> gr;
+    for (const auto* label : {"a", "b", "c", "d", "e", "f", "g"}) {
+        gr.create_node (label);
+    }
+    gr.connect_node ("a", "b");
+    gr.connect_node ("a", "c");
+    gr.connect_node ("b", "d");
+    gr.connect_node ("c", "e");
+    gr.connect_node ("e", "d");
+    gr.connect_node ("d", "f");
+    gr.connect_node ("f", "a");
+
+    struct recorder {
+        std::string discovered;
+        std::string finished;
+        size_t      edges = 0;
+
+        void
+        discover (const node<int>& n) {
+            discovered += n.label();
+        }
+
+        void
+        examine_edge (const node<int>&, const node<int>&) {
+            ++edges;
+        }
+
+        void
+        finish (const node<int>& n) {
+            finished += n.label();
+        }
+    };
+
+    recorder order;
+    EXPECT_TRUE (gr.breadth_first (*gr.id ("a"), order));
+    EXPECT_EQ (order.discovered, "abcdef");
+    EXPECT_EQ (order.finished, "abcdef");
+    EXPECT_EQ (order.edges, gr.count_connections());
+
+    // Skipping an edge leaves its tail to be reached some other way.
+    breadth_first_search<int> engine;
+    std::string               discovered;
+    struct {
+        std::string& discovered;
+
+        void
+        discover (const node<int>& n) {
+            discovered += n.label();
+        }
+
+        visit
+        examine_edge (const node<int>& head, const node<int>& tail) {
+            return head.label() == "b" && tail.label() == "d" ? visit::skip : visit::proceed;
+        }
+    } skipper{discovered};
+    EXPECT_TRUE (gr.breadth_first (engine, *gr.id ("b"), skipper));
+    EXPECT_EQ (discovered, "b");
+    discovered.clear();
+    EXPECT_TRUE (gr.breadth_first (engine, *gr.id ("a"), skipper));
+    EXPECT_EQ (discovered, "abcedf");
+
+    EXPECT_TRUE (gr.is_reachable ("c", "b"));
+    EXPECT_TRUE (gr.is_reachable ("g", "g"));
+    EXPECT_FALSE (gr.is_reachable ("a", "g"));
+    EXPECT_FALSE (gr.is_reachable ("a", "z"));
+
+    EXPECT_EQ (gr.path ("c", "b"), (std::vector<std::string>{"c", "e", "d", "f", "a", "b"}));
+    EXPECT_EQ (gr.path ("a", "f"), (std::vector<std::string>{"a", "b", "d", "f"}));
+    EXPECT_EQ (gr.path ("g", "g"), (std::vector<std::string>{"g"}));
+    EXPECT_TRUE (gr.path ("a", "g").empty());
+
+    // Reused buffers give the same answers as fresh ones, whatever the
+    // earlier queries left in them.
+    std::vector<node_id> parent;
+    std::vector<node_id> path;
+    for (node_id h = 0; h < gr.id_bound(); ++h) {
+        for (node_id t = 0; t < gr.id_bound(); ++t) {
+            EXPECT_EQ (gr.is_reachable (engine, h, t), gr.is_reachable (h, t));
+            EXPECT_EQ (gr.path (engine, parent, h, t, path), !gr.path (h, t).empty());
+            EXPECT_EQ (path, gr.path (h, t));
+        }
+    }
+}
+
+TEST (Digraph, Weights) {
+    digraph<int, double> gr;
+    for (int i = 0; i < 40; ++i) {
+        gr.create_node (std::to_string (i));
+    }
+
+    // Enough edges on node 0 for the position index to kick in.
+    for (node_id id = 1; id < 40; ++id) {
+        gr.connect_node (0, id, id * 0.5);
+    }
+    gr.connect_node ("1", "2");
+    EXPECT_EQ (gr.weight (0, 7), 3.5);
+    EXPECT_EQ (gr.weight ("1", "2"), 0.0);
+    EXPECT_FALSE (gr.weight (2, 1));
+
+    // Connecting again updates the weight, and removals keep the remaining
+    // weights with their edges.
+    gr.connect_node ("0", "7", 100.0);
+    EXPECT_EQ (gr.weight (0, 7), 100.0);
+
+    // Connecting again without a weight leaves the edge as it is.
+    gr.connect_node ("0", "7");
+    gr.connect_node (0, 7);
+    EXPECT_EQ (gr.weight (0, 7), 100.0);
+    EXPECT_EQ (gr.count_connections(), 40);
+    for (node_id id = 1; id < 40; id += 2) {
+        gr.remove_node (id);
+    }
+    for (node_id id = 2; id < 40; id += 2) {
+        EXPECT_EQ (gr.weight (0, id), id * 0.5);
+    }
+
+    const auto frozen = gr.freeze();
+    EXPECT_EQ (frozen.count_connections(), 19);
+    const auto edges   = frozen.edges (0);
+    const auto weights = frozen.weights (0);
+    ASSERT_EQ (weights.size(), edges.size());
+    EXPECT_TRUE (std::is_sorted (edges.begin(), edges.end()));
+    for (size_t i = 0; i < edges.size(); ++i) {
+        EXPECT_EQ (weights[i], std::stod (std::string{frozen.label (edges[i])}) * 0.5);
+    }
+    EXPECT_EQ (frozen.weight (0, *frozen.id ("38")), 19.0);
+    EXPECT_FALSE (frozen.weight (*frozen.id ("38"), 0));
+}
+
+TEST (Digraph, StringData) {
+    digraph<std::string> gr;
+
+    for (int i = 0; i < 100; ++i) {
+        gr.create_node (std::to_string (i), std::string (64, 'a' + i % 26));
+    }
+    for (int i = 0; i < 100; ++i) {
+        gr.connect_node (std::to_string (i), std::to_string ((i * 7) % 100));
+        gr.connect_node (std::to_string (0), std::to_string (i));
+    }
+    EXPECT_EQ (gr.size(), 100);
+
+    for (int i = 0; i < 100; i += 3) {
+        gr.remove_node (std::to_string (i));
+    }
+    for (int i = 0; i < 100; i += 3) {
+        gr.create_node (std::to_string (i), "again");
+    }
+    EXPECT_EQ (gr.size(), 100);
+
+    auto frozen = gr.freeze();
+    EXPECT_EQ (frozen.data (*frozen.id ("3")), "again");
+    EXPECT_EQ (frozen.data (*frozen.id ("4")), std::string (64, 'e'));
+
+    // Moving a graph keeps its nodes and frees the ones it replaces
+    digraph<std::string> other;
+    other.create_node ("X", "x");
+    other = std::move (gr);
+    EXPECT_EQ (other.size(), 100);
+
+    // Moving by construction as well
+    digraph<std::string> relay{std::move (other)};
+    other = std::move (relay);
+    EXPECT_EQ (other.size(), 100);
+    EXPECT_TRUE (other.is_connected ("1", "7"));
+    EXPECT_FALSE (other.id ("X").has_value());
+
+    // A move leaves the source empty, but usable.
+    for (auto* moved : {&gr, &relay}) {
+        EXPECT_EQ (moved->size(), 0);
+        EXPECT_FALSE (moved->id ("1").has_value());
+        EXPECT_FALSE (moved->is_connected ("1", "7"));
+        EXPECT_EQ (moved->create_node ("1", "new"), 0);
+        EXPECT_EQ (moved->create_node ("7"), 1);
+        moved->connect_node ("1", "7");
+        EXPECT_TRUE (moved->is_connected ("1", "7"));
+        EXPECT_EQ (moved->data ("1"), "new");
+    }
+}
+
+TEST (Digraph, FromEdges) {
+    std::vector<std::pair<std::string, std::string>> edges{
+        {"A", "B"},
+        {"B", "C"},
+        {"A", "B"},
+        {"C", "A"},
+        {"C", "C"},
+        {"D", "A"},
+    };
+    // A hub with enough edges to be indexed by hash
+    for (int i = 0; i < 50; ++i) {
+        edges.emplace_back ("H", std::to_string (i));
+        edges.emplace_back (std::to_string (i), "H");
+    }
+
+    auto gr = digraph<int>::from_edges (edges, 2);
+    EXPECT_EQ (gr.size(), 55);
+    EXPECT_EQ (gr.count_connections(), 105);
+
+    // Nodes are numbered in order of first appearance
+    EXPECT_EQ (gr.id ("A"), 0);
+    EXPECT_EQ (gr.id ("B"), 1);
+    EXPECT_EQ (gr.id ("C"), 2);
+    EXPECT_EQ (gr.id ("D"), 3);
+
+    EXPECT_TRUE (gr.is_connected ("A", "B"));
+    EXPECT_TRUE (gr.is_connected ("C", "C"));
+    EXPECT_FALSE (gr.is_connected ("B", "A"));
+    EXPECT_EQ (gr.in_degree ("A"), 2);
+    EXPECT_EQ (gr.in_degree ("C"), 2);
+    EXPECT_EQ (gr.in_degree ("H"), 50);
+    EXPECT_TRUE (gr.is_connected ("H", "42"));
+    EXPECT_TRUE (gr.is_connected ("42", "H"));
+
+    // The graph behaves like one built node by node
+    gr.connect_node ("H", "42");
+    EXPECT_EQ (gr.count_connections(), 105);
+    gr.remove_node ("H");
+    EXPECT_EQ (gr.count_connections(), 5);
+    EXPECT_EQ (gr.in_degree ("42"), 0);
+
+    gr.remove_node ("A");
+    EXPECT_EQ (gr.in_degree ("B"), 0);
+    EXPECT_EQ (gr.in_degree ("C"), 2);
+    EXPECT_EQ (gr.count_connections(), 2);
+}
+
+TEST (ShortestPath, Dijkstra) {
+    // Random graph, checked against Bellman-Ford.
+    const node_id          count = 200;
+    digraph<int, unsigned> gr;
+    for (node_id id = 0; id < count; ++id) {
+        gr.create_node (std::to_string (id));
+    }
+
+    std::mt19937                            gen{11};
+    std::uniform_int_distribution<node_id>  any{0, count - 1};
+    std::uniform_int_distribution<unsigned> length{1, 20};
+    for (int i = 0; i < 800; ++i) {
+        gr.connect_node (any (gen), any (gen), length (gen));
+    }
+    const auto frozen = gr.freeze();
+
+    using search = shortest_path_search<unsigned>;
+
+    std::vector<unsigned> reference (count, search::unreachable);
+    reference[0] = 0;
+    for (node_id round = 1; round < count; ++round) {
+        for (node_id head = 0; head < count; ++head) {
+            if (reference[head] == search::unreachable) continue;
+
+            for (size_t i = 0; i < frozen.edges (head).size(); ++i) {
+                const auto tail = frozen.edges (head)[i];
+                const auto via  = reference[head] + frozen.weights (head)[i];
+                reference[tail] = std::min (reference[tail], via);
+            }
+        }
+    }
+
+    search engine;
+    engine.dijkstra (frozen, 0);
+    for (node_id id = 0; id < count; ++id) {
+        EXPECT_EQ (engine.distance (id), reference[id]);
+    }
+
+    // Point-to-point searches reuse the engine, and the path adds up to the
+    // distance.
+    for (node_id target = 0; target < count; target += 7) {
+        const auto distance = engine.dijkstra (frozen, 0, target);
+        if (reference[target] == search::unreachable) {
+            EXPECT_FALSE (distance);
+            EXPECT_TRUE (engine.path (target).empty());
+            continue;
+        }
+        ASSERT_TRUE (distance);
+        EXPECT_EQ (*distance, reference[target]);
+
+        const auto path = engine.path (target);
+        ASSERT_FALSE (path.empty());
+        EXPECT_EQ (path.front(), 0);
+        EXPECT_EQ (path.back(), target);
+        unsigned total = 0;
+        for (size_t i = 1; i < path.size(); ++i) {
+            total += *frozen.weight (path[i - 1], path[i]);
+        }
+        EXPECT_EQ (total, *distance);
+    }
+
+    EXPECT_FALSE (engine.dijkstra (frozen, 0, count));
+    EXPECT_FALSE (engine.dijkstra (frozen, count, 0));
+}
+
+TEST (ShortestPath, AStar) {
+    // Grid with edges to the right and downwards, each of length 2 or 3.
+    // Twice the Manhattan distance never overestimates and is consistent.
+    const node_id        side = 30;
+    digraph<int, double> gr;
+    for (node_id id = 0; id < side * side; ++id) {
+        gr.create_node (std::to_string (id));
+    }
+    for (node_id row = 0; row < side; ++row) {
+        for (node_id col = 0; col < side; ++col) {
+            const auto id = row * side + col;
+            if (col + 1 < side) gr.connect_node (id, id + 1, 2.0 + (id % 2));
+            if (row + 1 < side) gr.connect_node (id, id + side, 2.0 + (id % 3 == 0));
+        }
+    }
+    const auto frozen = gr.freeze();
+
+    shortest_path_search<double> dijkstra;
+    shortest_path_search<double> a_star;
+    for (node_id target = 0; target < side * side; target += 37) {
+        const auto heuristic = [&] (const node_id id) {
+            const auto rows = static_cast<double> (target / side) - static_cast<double> (id / side);
+            const auto cols = static_cast<double> (target % side) - static_cast<double> (id % side);
+            return 2.0 * (rows + cols);
+        };
+        const auto expected = dijkstra.dijkstra (frozen, 0, target);
+        EXPECT_EQ (a_star.a_star (frozen, 0, target, heuristic), expected);
+    }
+
+    // Nothing leads back up or left.
+    EXPECT_FALSE (a_star.a_star (frozen, side * side - 1, 0, [] (node_id) { return 0.0; }));
+}
+
+TEST (ParallelBfs, MatchesSequential) {
+    // A sparse graph, searched mostly top-down, and a dense one, where the
+    // search turns bottom-up after the first level.
+    for (const size_t degree : {2, 40}) {
+        const node_id count = 5000;
+        digraph<int>  gr;
+        for (node_id id = 0; id < count; ++id) {
+            gr.create_node (std::to_string (id));
+        }
+
+        std::mt19937                           gen{17};
+        std::uniform_int_distribution<node_id> any{0, count - 1};
+        for (size_t i = 0; i < degree * count; ++i) {
+            gr.connect_node (any (gen), any (gen));
+        }
+        const auto frozen = gr.freeze();
+
+        // Depths from the sequential search.
+        std::vector<std::uint32_t> expected (count, breadth_first_tree::unreached);
+        expected[0] = 0;
+        struct {
+            std::vector<std::uint32_t>& depth;
+
+            void
+            examine_edge (const node<int>& head, const node<int>& tail) {
+                if (depth[tail.id()] == breadth_first_tree::unreached) {
+                    depth[tail.id()] = depth[head.id()] + 1;
+                }
+            }
+        } visitor{expected};
+        gr.breadth_first (0, visitor);
+
+        for (const size_t threads : {1, 4}) {
+            const auto tree = parallel_breadth_first (frozen, 0, threads);
+            EXPECT_EQ (tree.depth, expected);
+            EXPECT_EQ (tree.parent[0], 0);
+            for (node_id id = 1; id < count; ++id) {
+                if (tree.depth[id] == breadth_first_tree::unreached) {
+                    EXPECT_EQ (tree.parent[id], invalid_node);
+                    continue;
+                }
+                // Every parent is one level up, with an edge to its child.
+                const auto parent = tree.parent[id];
+                EXPECT_EQ (tree.depth[parent] + 1, tree.depth[id]);
+                EXPECT_TRUE (frozen.is_connected (parent, id));
+            }
+        }
+    }
+
+    const auto empty = parallel_breadth_first (csr_digraph<int>{}, 0);
+    EXPECT_TRUE (empty.parent.empty());
+}
+
+TEST (Digraph, StrongComponents) {
+    // a -> b -> c -> a, c -> d, d <-> e, and f on its own.
+    digraph<int> small;
+    for (const auto* label : {"a", "b", "c", "d", "e", "f"}) {
+        small.create_node (label);
+    }
+    for (const auto& [head, tail] : std::vector<std::pair<std::string, std::string>>{
+             {"a", "b"}, {"b", "c"}, {"c", "a"}, {"c", "d"}, {"d", "e"}, {"e", "d"}
+         }) {
+        small.connect_node (head, tail);
+    }
+
+    const auto scc = small.strongly_connected_components();
+    ASSERT_EQ (scc.count, 3);
+    EXPECT_EQ (scc.component[0], scc.component[1]);
+    EXPECT_EQ (scc.component[1], scc.component[2]);
+    EXPECT_EQ (scc.component[3], scc.component[4]);
+    EXPECT_NE (scc.component[2], scc.component[3]);
+    EXPECT_NE (scc.component[5], scc.component[0]);
+
+    // Reverse topological order: {a, b, c} reaches {d, e}.
+    EXPECT_GT (scc.component[0], scc.component[3]);
+
+    const auto dag = small.condensation (scc);
+    ASSERT_EQ (dag.size(), 3);
+    EXPECT_EQ (dag.count_connections(), 1);
+    EXPECT_TRUE (dag.is_connected (scc.component[0], scc.component[3]));
+    EXPECT_EQ (dag.data (scc.component[3]), (std::vector<node_id>{3, 4}));
+
+    // Removed nodes have no component.
+    small.remove_node ("f");
+    EXPECT_EQ (small.strongly_connected_components().component[5], invalid_node);
+
+    // Same partition from every engine on a random graph, large enough for
+    // the parallel one to split its first subgraph across threads.
+    const node_id count = 20000;
+    digraph<int>  gr;
+    for (node_id id = 0; id < count; ++id) {
+        gr.create_node (std::to_string (id));
+    }
+    std::mt19937                           gen{21};
+    std::uniform_int_distribution<node_id> any{0, count - 1};
+    for (size_t i = 0; i < count * 3 / 2; ++i) {
+        gr.connect_node (any (gen), any (gen));
+    }
+    const auto frozen = gr.freeze();
+
+    // Whether `b` numbers the same partition as `a`.
+    const auto same_partition = [] (const strong_components& a, const strong_components& b) {
+        if (a.count != b.count || a.component.size() != b.component.size()) return false;
+
+        std::vector<node_id> map (a.count, invalid_node);
+        for (size_t id = 0; id < a.component.size(); ++id) {
+            auto& image = map[a.component[id]];
+            if (image == invalid_node) image = b.component[id];
+            if (image != b.component[id]) return false;
+        }
+        return true;
+    };
+
+    const auto expected = gr.strongly_connected_components();
+    EXPECT_LT (expected.count, count);
+    EXPECT_TRUE (same_partition (expected, strongly_connected_components (frozen)));
+    for (const size_t threads : {1, 4}) {
+        EXPECT_TRUE (same_partition (
+            expected, parallel_strongly_connected_components (frozen, threads)
+        ));
+    }
+
+    // Every edge of the condensation goes down the numbers.
+    const auto condensed = gr.condensation (expected);
+    EXPECT_EQ (condensed.size(), expected.count);
+    for (node_id c = 0; c < condensed.size(); ++c) {
+        const auto members = *condensed.data (c);
+        for (const auto id : members) {
+            EXPECT_EQ (expected.component[id], c);
+        }
+    }
+    for (node_id head = 0; head < count; ++head) {
+        for (node_id tail = 0; tail < count; tail += 97) {
+            const auto from = expected.component[head];
+            const auto to   = expected.component[tail];
+            if (gr.is_connected (head, tail) && from != to) {
+                EXPECT_GT (from, to);
+                EXPECT_TRUE (condensed.is_connected (from, to));
+            }
+        }
+    }
+
+    // A ring deep enough to overflow the stack if the search recursed once
+    // per node.
+    const node_id ring_size = 300000;
+    digraph<int>  ring;
+    ring.reserve (ring_size);
+    for (node_id id = 0; id < ring_size; ++id) {
+        ring.create_node (std::to_string (id));
+    }
+    for (node_id id = 0; id < ring_size; ++id) {
+        ring.connect_node (id, (id + 1) % ring_size);
+    }
+    EXPECT_EQ (ring.strongly_connected_components().count, 1);
+    EXPECT_EQ (parallel_strongly_connected_components (ring.freeze(), 4).count, 1);
+}
+
+TEST (Digraph, TopologicalSort) {
+    // a -> c, a -> d, b -> d, c -> e, d -> e and d -> f.
+    digraph<int> gr;
+    for (const auto* label : {"a", "b", "c", "d", "e", "f"}) {
+        gr.create_node (label);
+    }
+    for (const auto& [head, tail] : std::vector<std::pair<std::string, std::string>>{
+             {"a", "c"}, {"a", "d"}, {"b", "d"}, {"c", "e"}, {"d", "e"}, {"d", "f"}
+         }) {
+        gr.connect_node (head, tail);
+    }
+
+    const auto sorted = gr.topological_sort();
+    EXPECT_TRUE (sorted.acyclic());
+    ASSERT_EQ (sorted.order.size(), 6);
+    ASSERT_EQ (sorted.level_count(), 3);
+    const auto level = [&sorted] (const size_t i) {
+        return std::vector<node_id> (sorted.level (i).begin(), sorted.level (i).end());
+    };
+    EXPECT_EQ (level (0), (std::vector<node_id>{0, 1}));
+    EXPECT_EQ (level (1), (std::vector<node_id>{2, 3}));
+    EXPECT_EQ (level (2), (std::vector<node_id>{4, 5}));
+
+    const auto frozen = topological_sort (gr.freeze());
+    EXPECT_EQ (frozen.order, sorted.order);
+    EXPECT_EQ (frozen.offsets, sorted.offsets);
+
+    // Removed nodes are skipped.
+    gr.remove_node ("b");
+    EXPECT_EQ (gr.topological_sort().order.size(), 5);
+
+    // e -> b -> a closes the cycles through c and d, which every node is on
+    // or behind.
+    gr.create_node ("b");
+    gr.connect_node ("e", "b");
+    gr.connect_node ("b", "a");
+    const auto cyclic = gr.topological_sort();
+    EXPECT_FALSE (cyclic.acyclic());
+    EXPECT_TRUE (cyclic.order.empty());
+    ASSERT_EQ (cyclic.cycle.size(), 4);
+    for (size_t i = 0; i < cyclic.cycle.size(); ++i) {
+        EXPECT_TRUE (gr.is_connected (
+            cyclic.cycle[i], cyclic.cycle[(i + 1) % cyclic.cycle.size()]
+        ));
+    }
+
+    // A self-loop is a cycle of one node.
+    digraph<int> loop;
+    loop.create_node ("x");
+    loop.connect_node ("x", "x");
+    EXPECT_EQ (loop.topological_sort().cycle, std::vector<node_id>{0});
+
+    // Random graphs, acyclic with every edge going up the ids, then with one
+    // edge back added.
+    const node_id count = 5000;
+    digraph<int>  dag;
+    for (node_id id = 0; id < count; ++id) {
+        dag.create_node (std::to_string (id));
+    }
+    std::mt19937                           gen{4};
+    std::uniform_int_distribution<node_id> any{0, count - 1};
+    for (size_t i = 0; i < 4 * count; ++i) {
+        const auto a = any (gen), b = any (gen);
+        if (a != b) dag.connect_node (std::min (a, b), std::max (a, b));
+    }
+
+    const auto levels = dag.topological_sort();
+    ASSERT_TRUE (levels.acyclic());
+    ASSERT_EQ (levels.order.size(), count);
+    std::vector<size_t> level_of (count);
+    for (size_t l = 0; l < levels.level_count(); ++l) {
+        for (const auto id : levels.level (l)) {
+            level_of[id] = l;
+        }
+    }
+    for (node_id head = 0; head < count; ++head) {
+        for (node_id tail = head + 1; tail < count; tail += 13) {
+            if (dag.is_connected (head, tail)) {
+                EXPECT_LT (level_of[head], level_of[tail]);
+            }
+        }
+    }
+
+    dag.connect_node (levels.order.back(), levels.order.front());
+    const auto broken = dag.topological_sort();
+    ASSERT_FALSE (broken.acyclic());
+    const auto& cycle = broken.cycle;
+    for (size_t i = 0; i < cycle.size(); ++i) {
+        EXPECT_TRUE (dag.is_connected (cycle[i], cycle[(i + 1) % cycle.size()]));
+    }
+}
+
+TEST (WorkStealingPool, SpawnedJobs) {
+    // Job `i` spawns jobs `2i + 1` and `2i + 2`, up to `count` jobs.
+    const node_id count = 100000;
+    for (const size_t threads : {1, 4}) {
+        work_stealing_pool pool{threads};
+        EXPECT_EQ (pool.size(), threads);
+
+        std::vector<std::atomic<int>> runs (count);
+        for (int batch = 0; batch < 3; ++batch) {
+            const std::vector<node_id> seeds{0};
+            pool.run (seeds, [&] (const node_id job, work_stealing_pool::spawner& sp) {
+                runs[job].fetch_add (1, std::memory_order_relaxed);
+                for (const auto child : {2 * job + 1, 2 * job + 2}) {
+                    if (child < count) sp.spawn (child);
+                }
+            });
+        }
+        EXPECT_TRUE (std::all_of (runs.begin(), runs.end(), [] (const auto& r) {
+            return r.load() == 3;
+        }));
+    }
+}
+
+TEST (DagExecutor, DependencyOrder) {
+    // Layers of nodes, each depending on random nodes of the layers above.
+    const node_id width = 200, depth = 50, count = width * depth;
+    digraph<int>  gr;
+    for (node_id id = 0; id < count; ++id) {
+        gr.create_node (std::to_string (id));
+    }
+    std::mt19937 gen{6};
+    for (node_id id = width; id < count; ++id) {
+        std::uniform_int_distribution<node_id> above{0, id / width * width - 1};
+        for (int i = 0; i < 3; ++i) {
+            gr.connect_node (above (gen), id);
+        }
+    }
+    const auto frozen = gr.freeze();
+
+    work_stealing_pool  pool{4};
+    dag_executor<int>   executor{frozen};
+    std::atomic<size_t> clock{0};
+    std::vector<size_t> finished (count);
+    for (int run = 0; run < 2; ++run) {
+        std::vector<std::atomic<int>> runs (count);
+        EXPECT_TRUE (executor.run (pool, [&] (const node_id id) {
+            // Every predecessor has finished before.
+            for (const auto head : frozen.in_edges (id)) {
+                EXPECT_EQ (runs[head].load(), 1);
+            }
+            runs[id].fetch_add (1);
+            finished[id] = clock++;
+        }));
+        for (node_id id = 0; id < count; ++id) {
+            ASSERT_EQ (runs[id].load(), 1);
+            for (const auto tail : frozen.edges (id)) {
+                ASSERT_LT (finished[id], finished[tail]);
+            }
+        }
+    }
+
+    // Nodes whose data is callable run it.
+    int                             total = 0;
+    digraph<std::function<void ()>> tasks;
+    tasks.create_node ("a", [&total] { total += 1; });
+    tasks.create_node ("b", [&total] { total *= 10; });
+    tasks.create_node ("c", [&total] { total += 2; });
+    tasks.connect_node ("a", "b");
+    tasks.connect_node ("b", "c");
+    const auto                           frozen_tasks = tasks.freeze();
+    dag_executor<std::function<void ()>> chain{frozen_tasks};
+    EXPECT_TRUE (chain.run (pool));
+    EXPECT_EQ (total, 12);
+
+    // Nodes on a cycle, or behind one, never run.
+    tasks.connect_node ("c", "b");
+    tasks.create_node ("d", [&total] { total = -1; });
+    tasks.connect_node ("c", "d");
+    const auto                           cyclic_tasks = tasks.freeze();
+    dag_executor<std::function<void ()>> cyclic{cyclic_tasks};
+    total = 0;
+    EXPECT_FALSE (cyclic.run (pool));
+    EXPECT_EQ (total, 1);
+}
+
+TEST (PageRank, Scores) {
+    // 0 and 1 point at each other, and 2 points at 0.  With a damping of
+    // 0.85, node 2 keeps only its jump probability, 0.05, and the others
+    // solve s0 = 0.05 + 0.85 (s1 + s2), s1 = 0.05 + 0.85 s0.
+    digraph<int> small;
+    for (const auto* label : {"0", "1", "2"}) {
+        small.create_node (label);
+    }
+    small.connect_node ("0", "1");
+    small.connect_node ("1", "0");
+    small.connect_node ("2", "0");
+
+    const auto ranks = page_rank (small.freeze(), {.tolerance = 1e-12, .max_iterations = 1000});
+    EXPECT_TRUE (ranks.converged);
+    ASSERT_EQ (ranks.score.size(), 3);
+    EXPECT_NEAR (ranks.score[0], 0.135 / 0.2775, 1e-9);
+    EXPECT_NEAR (ranks.score[1], 0.05 + 0.85 * 0.135 / 0.2775, 1e-9);
+    EXPECT_NEAR (ranks.score[2], 0.05, 1e-9);
+
+    // The iteration cap stops a run short of convergence.
+    const auto capped = page_rank (small.freeze(), {.tolerance = 0, .max_iterations = 3});
+    EXPECT_FALSE (capped.converged);
+    EXPECT_EQ (capped.iterations, 3);
+
+    // A large graph with dangling nodes: the scores still sum to 1, and do
+    // not depend on the number of threads or, much, on the precision.
+    const node_id count = 20000;
+    digraph<int>  gr;
+    for (node_id id = 0; id < count; ++id) {
+        gr.create_node (std::to_string (id));
+    }
+    std::mt19937                           gen{7};
+    std::uniform_int_distribution<node_id> any{0, count - 1};
+    for (node_id id = 0; id < count; ++id) {
+        if (id % 10 == 0) continue;
+
+        for (int i = 0; i < 4; ++i) {
+            gr.connect_node (id, any (gen));
+        }
+    }
+    const auto frozen = gr.freeze();
+
+    const auto one  = page_rank (frozen, {.tolerance = 1e-10, .threads = 1});
+    const auto four = page_rank (frozen, {.tolerance = 1e-10, .threads = 4});
+    const auto fast = page_rank<float> (frozen, {.tolerance = 1e-5, .threads = 4});
+    EXPECT_TRUE (one.converged);
+    EXPECT_NEAR (std::accumulate (one.score.begin(), one.score.end(), 0.0), 1.0, 1e-9);
+    EXPECT_NEAR (std::accumulate (fast.score.begin(), fast.score.end(), 0.0f), 1.0f, 1e-3f);
+    for (node_id id = 0; id < count; ++id) {
+        ASSERT_NEAR (one.score[id], four.score[id], 1e-12);
+        ASSERT_NEAR (one.score[id], fast.score[id], 1e-5);
+    }
+
+    EXPECT_TRUE (page_rank (csr_digraph<int>{}).score.empty());
+}
+
+TEST (PageRank, Personalized) {
+    // Two chains, 0 -> 1 -> 2 and 3 -> 4, and a seed at 0.
+    digraph<int> gr;
+    for (const auto* label : {"0", "1", "2", "3", "4"}) {
+        gr.create_node (label);
+    }
+    gr.connect_node ("0", "1");
+    gr.connect_node ("1", "2");
+    gr.connect_node ("3", "4");
+    const auto frozen = gr.freeze();
+
+    const page_rank_options    exact{.tolerance = 1e-12, .max_iterations = 1000};
+    const std::vector<node_id> seeds{0};
+    const auto                 ranks = personalized_page_rank (frozen, seeds, exact);
+    EXPECT_TRUE (ranks.converged);
+    EXPECT_NEAR (std::accumulate (ranks.score.begin(), ranks.score.end(), 0.0), 1.0, 1e-9);
+    EXPECT_GT (ranks.score[0], ranks.score[1]);
+    EXPECT_GT (ranks.score[1], ranks.score[2]);
+    EXPECT_GT (ranks.score[2], 0.0);
+    EXPECT_EQ (ranks.score[3], 0.0);
+    EXPECT_EQ (ranks.score[4], 0.0);
+
+    // Repeated seeds count once, and so do both seeds of a pair alike.
+    const std::vector<node_id> pair{0, 3, 3};
+    const auto                 both = personalized_page_rank (frozen, pair, exact);
+    EXPECT_NEAR (both.score[0], both.score[3], 1e-9);
+    EXPECT_GT (both.score[4], 0.0);
+
+    // Without a valid seed, nothing scores.
+    const std::vector<node_id> none{invalid_node};
+    const auto                 empty = personalized_page_rank (frozen, none);
+    EXPECT_TRUE (std::all_of (empty.score.begin(), empty.score.end(), [] (double s) {
+        return s == 0.0;
+    }));
+}
+
+TEST (Centrality, Scores) {
+    // A path 0 -> 1 -> 2 -> 3, and a diamond 4 -> {5, 6} -> 7.
+    digraph<int> gr;
+    for (const auto* label : {"0", "1", "2", "3", "4", "5", "6", "7"}) {
+        gr.create_node (label);
+    }
+    const std::vector<std::pair<std::string, std::string>> edges{
+        {"0", "1"}, {"1", "2"}, {"2", "3"}, {"4", "5"}, {"4", "6"}, {"5", "7"}, {"6", "7"}
+    };
+    for (const auto& [head, tail] : edges) {
+        gr.connect_node (head, tail);
+    }
+
+    const auto scores = centrality (gr.freeze());
+    EXPECT_EQ (scores.sources, 8);
+
+    const std::vector<double> betweenness{0, 2, 2, 0, 0, 0.5, 0.5, 0};
+    for (node_id id = 0; id < 8; ++id) {
+        EXPECT_DOUBLE_EQ (scores.betweenness[id], betweenness[id]);
+    }
+
+    // Node 3 is reached by three nodes out of seven, at distances 1, 2 and
+    // 3; node 7 by three too, at distances 1, 1 and 2.
+    EXPECT_DOUBLE_EQ (scores.harmonic[3], 1.0 + 1.0 / 2 + 1.0 / 3);
+    EXPECT_DOUBLE_EQ (scores.closeness[3], 3.0 / 6 * 3.0 / 7);
+    EXPECT_DOUBLE_EQ (scores.harmonic[7], 2.5);
+    EXPECT_DOUBLE_EQ (scores.closeness[7], 3.0 / 4 * 3.0 / 7);
+    EXPECT_EQ (scores.harmonic[0], 0.0);
+    EXPECT_EQ (scores.closeness[0], 0.0);
+
+    // On a larger graph, the threads only split the work.
+    const node_id count = 2000;
+    digraph<int>  large;
+    for (node_id id = 0; id < count; ++id) {
+        large.create_node (std::to_string (id));
+    }
+    std::mt19937                           gen{8};
+    std::uniform_int_distribution<node_id> any{0, count - 1};
+    for (node_id i = 0; i < 4 * count; ++i) {
+        large.connect_node (any (gen), any (gen));
+    }
+    const auto frozen = large.freeze();
+
+    const auto one  = centrality (frozen, {.threads = 1});
+    const auto four = centrality (frozen, {.threads = 4});
+    for (node_id id = 0; id < count; ++id) {
+        ASSERT_NEAR (one.betweenness[id], four.betweenness[id], 1e-6);
+        ASSERT_NEAR (one.closeness[id], four.closeness[id], 1e-12);
+        ASSERT_NEAR (one.harmonic[id], four.harmonic[id], 1e-9);
+    }
+
+    // Sampling a quarter of the sources estimates the totals closely.
+    const auto sampled = centrality (frozen, {.samples = count / 4, .threads = 4});
+    EXPECT_EQ (sampled.sources, count / 4);
+    const auto total = [] (const std::vector<double>& v) {
+        return std::accumulate (v.begin(), v.end(), 0.0);
+    };
+    EXPECT_NEAR (total (sampled.betweenness) / total (one.betweenness), 1.0, 0.05);
+    EXPECT_NEAR (total (sampled.harmonic) / total (one.harmonic), 1.0, 0.05);
+    EXPECT_NEAR (total (sampled.closeness) / total (one.closeness), 1.0, 0.05);
+
+    EXPECT_TRUE (centrality (csr_digraph<int>{}).betweenness.empty());
+}
+
 TEST (Tree, Creation) {
     tree<int> tr{"O"};
 
@@ -200,6 +1410,42 @@ TEST (Tree, Creation) {
     tr.append_node ("I", "I");
 
     EXPECT_EQ (tr.size(), 6);
+
+    // Unknown parent: the node should not be appended
+    tr.append_node ("Z", "K");
+    EXPECT_EQ (tr.size(), 6);
+    EXPECT_TRUE (tr.path ("K").empty());
+}
+
+TEST (Tree, Handles) {
+    tree<int> tr{"A"};
+
+    auto root = tr.root();
+    EXPECT_EQ (tr.label (root), "A");
+    EXPECT_EQ (tr.label (100), std::nullopt);
+
+    auto b = tr.append_node (root, "B");
+    auto c = tr.append_node (b, "C");
+    auto d = tr.append_node ("A", "D");
+    EXPECT_EQ (tr.size(), 4);
+    EXPECT_EQ (tr.id ("C"), c);
+
+    // Duplicate label or unknown parent
+    EXPECT_EQ (tr.append_node (root, "C"), invalid_node);
+    EXPECT_EQ (tr.append_node (100, "E"), invalid_node);
+    EXPECT_EQ (tr.size(), 4);
+
+    auto path = tr.path (c);
+    ASSERT_EQ (path.size(), 3);
+    EXPECT_EQ (path[0], root);
+    EXPECT_EQ (path[1], b);
+    EXPECT_EQ (path[2], c);
+
+    EXPECT_EQ (tr.depth (c), 2);
+
+    EXPECT_TRUE (tr.is_descendent_of (c, root));
+    EXPECT_TRUE (tr.is_ancestor_of (b, c));
+    EXPECT_FALSE (tr.is_descendent_of (c, d));
 }
 
 TEST (Tree, Search) {
@@ -322,3 +1568,396 @@ TEST (Tree, Search) {
     EXPECT_EQ (path3_b[2], "H");
     EXPECT_EQ (path3_b[3], "M");
 }
+
+TEST (Tree, ParentsAndChildren) {
+    //   A
+    //   |
+    // .-.-.
+    // B   C
+    // |   |
+    // D   .-.
+    //     E F
+    tree<int> tr{"A"};
+    tr.append_node ("A", "B");
+    tr.append_node ("A", "C");
+    tr.append_node ("B", "D");
+    tr.append_node ("C", "E");
+    tr.append_node ("C", "F");
+
+    EXPECT_EQ (tr.parent ("A"), std::nullopt);
+    EXPECT_EQ (tr.parent ("D"), "B");
+    EXPECT_EQ (tr.parent ("F"), "C");
+    EXPECT_EQ (tr.parent ("G"), std::nullopt);
+    EXPECT_EQ (tr.parent (tr.root()), invalid_node);
+    EXPECT_EQ (tr.parent (100), invalid_node);
+
+    EXPECT_EQ (tr.depth ("A"), 0);
+    EXPECT_EQ (tr.depth ("C"), 1);
+    EXPECT_EQ (tr.depth ("E"), 2);
+    EXPECT_EQ (tr.depth ("G"), std::nullopt);
+    EXPECT_EQ (tr.depth (*tr.id ("E")), 2);
+    EXPECT_EQ (tr.depth (100), std::nullopt);
+
+    EXPECT_EQ (tr.children ("C"), (std::vector<std::string>{"E", "F"}));
+    EXPECT_EQ (tr.children ("A"), (std::vector<std::string>{"B", "C"}));
+    EXPECT_TRUE (tr.children ("D").empty());
+    EXPECT_TRUE (tr.children ("G").empty());
+    EXPECT_EQ (tr.children (*tr.id ("B")), std::vector<node_id>{*tr.id ("D")});
+
+    EXPECT_EQ (tr.path ("F"), (std::vector<std::string>{"A", "C", "F"}));
+    EXPECT_EQ (tr.path ("A"), std::vector<std::string>{"A"});
+    EXPECT_TRUE (tr.path ("G").empty());
+}
+
+TEST (Tree, AncestryAfterAppend) {
+    // Queries between appends must see the nodes appended since the last
+    // query.
+    tree<int> tr{"A"};
+    const auto b = tr.append_node ("A", "B");
+    EXPECT_TRUE (tr.is_descendent_of (b, tr.root()));
+
+    const auto c = tr.append_node ("A", "C");
+    const auto d = tr.append_node ("B", "D");
+    EXPECT_TRUE (tr.is_descendent_of (d, b));
+    EXPECT_FALSE (tr.is_descendent_of (d, c));
+    EXPECT_TRUE (tr.is_ancestor_of (tr.root(), c));
+
+    const auto e = tr.append_node ("C", "E");
+    EXPECT_TRUE (tr.is_descendent_of (e, c));
+    EXPECT_FALSE (tr.is_descendent_of (e, b));
+    EXPECT_FALSE (tr.is_descendent_of (b, e));
+    EXPECT_TRUE (tr.is_descendent_of (e, e));
+
+    // Unknown nodes are nobody's descendents.
+    EXPECT_FALSE (tr.is_descendent_of (100, tr.root()));
+    EXPECT_FALSE (tr.is_descendent_of (tr.root(), 100));
+    EXPECT_FALSE (tr.is_descendent_of ("F", "A"));
+}
+
+TEST (Tree, ConcurrentAncestryQueries) {
+    // The first queries after the appends race to renumber the tree; they
+    // must all see the same, complete numbering.
+    const size_t         count = 2000;
+    std::mt19937         gen{11};
+    std::vector<node_id> parents (count, invalid_node);
+
+    tree<int> tr{"0"};
+    for (size_t i = 1; i < count; ++i) {
+        parents[i] = std::uniform_int_distribution<node_id>{0, static_cast<node_id> (i - 1)}(gen);
+        tr.append_node (parents[i], std::to_string (i));
+    }
+
+    const auto is_descendent = [&parents] (node_id id, const node_id ancestor) {
+        for (; id != invalid_node; id = parents[id]) {
+            if (id == ancestor) return true;
+        }
+        return false;
+    };
+
+    std::atomic<size_t>      mismatches = 0;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 4; ++t) {
+        threads.emplace_back ([&, t] {
+            std::mt19937                           local{t};
+            std::uniform_int_distribution<node_id> pick{0, static_cast<node_id> (count - 1)};
+            for (int i = 0; i < 5000; ++i) {
+                const auto a = pick (local);
+                const auto b = pick (local);
+                if (tr.is_descendent_of (a, b) != is_descendent (a, b)) ++mismatches;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ (mismatches, 0);
+}
+
+TEST (Tree, DeepBreadthFirstSearch) {
+    // A chain deep enough to overflow the stack if the search recursed once
+    // per node.
+    const size_t count = 500000;
+
+    tree<int> tr{"0"};
+    tr.reserve (count);
+    for (size_t i = 1; i < count; ++i) {
+        tr.append_node (static_cast<node_id> (i - 1), std::to_string (i));
+    }
+
+    const auto path = tr.path (static_cast<node_id> (count - 1));
+    ASSERT_EQ (path.size(), count);
+    for (size_t i = 0; i < count; ++i) {
+        if (path[i] != i) {
+            ADD_FAILURE() << "path[" << i << "] = " << path[i];
+            break;
+        }
+    }
+
+    // A missing node has no path.
+    EXPECT_TRUE (tr.path (static_cast<node_id> (count)).empty());
+}
+
+TEST (Tree, DeepDepthFirstSearch) {
+    // A chain deep enough to overflow the stack if the search recursed once
+    // per node.
+    const size_t count = 500000;
+
+    tree<int> tr{"0"};
+    tr.reserve (count);
+    for (size_t i = 1; i < count; ++i) {
+        tr.append_node (static_cast<node_id> (i - 1), std::to_string (i));
+    }
+
+    const auto path = tr.path (static_cast<node_id> (count - 1));
+    ASSERT_EQ (path.size(), count);
+    EXPECT_EQ (path.front(), 0);
+    EXPECT_EQ (path.back(), count - 1);
+
+    EXPECT_TRUE (tr.is_descendent_of (static_cast<node_id> (count - 1), 1));
+    EXPECT_FALSE (tr.is_descendent_of (1, static_cast<node_id> (count - 1)));
+
+    // Pre-order and post-order hooks see every node, in opposite order here.
+    size_t depth = 0, max_depth = 0;
+    struct {
+        size_t& depth;
+        size_t& max_depth;
+
+        void
+        discover (const node<int>&) {
+            max_depth = std::max (max_depth, ++depth);
+        }
+
+        void
+        finish (const node<int>&) {
+            --depth;
+        }
+    } visitor{depth, max_depth};
+    EXPECT_TRUE (tr.depth_first (tr.root(), visitor));
+    EXPECT_EQ (depth, 0);
+    EXPECT_EQ (max_depth, count);
+
+    EXPECT_FALSE (tr.description().empty());
+}
+
+TEST (Tree, LowestCommonAncestor) {
+    // A random tree, checked against walking up the parent links.
+    const size_t         count = 2000;
+    std::mt19937         gen{3};
+    std::vector<node_id> parents (count, invalid_node);
+    std::vector<size_t>  depths (count, 0);
+
+    tree<int> tr{"0"};
+    for (size_t i = 1; i < count; ++i) {
+        parents[i] = std::uniform_int_distribution<node_id>{0, static_cast<node_id> (i - 1)}(gen);
+        depths[i]  = depths[parents[i]] + 1;
+        tr.append_node (parents[i], std::to_string (i));
+    }
+
+    const auto naive = [&] (node_id a, node_id b) {
+        while (depths[a] > depths[b]) a = parents[a];
+        while (depths[b] > depths[a]) b = parents[b];
+        while (a != b) {
+            a = parents[a];
+            b = parents[b];
+        }
+        return a;
+    };
+
+    const lca_index index{tr};
+    ASSERT_EQ (index.size(), count);
+
+    std::uniform_int_distribution<node_id> pick{0, static_cast<node_id> (count - 1)};
+    for (int i = 0; i < 2000; ++i) {
+        const auto a   = pick (gen);
+        const auto b   = pick (gen);
+        const auto top = naive (a, b);
+        ASSERT_EQ (index.lowest_common_ancestor (a, b), top) << a << ", " << b;
+        ASSERT_EQ (index.is_ancestor_of (a, b), top == a) << a << ", " << b;
+        ASSERT_EQ (index.is_descendent_of (a, b), tr.is_descendent_of (a, b)) << a << ", " << b;
+        ASSERT_EQ (index.distance (a, b), depths[a] + depths[b] - 2 * depths[top]);
+
+        const auto path = index.path (a, b);
+        ASSERT_EQ (path.size(), index.distance (a, b) + 1);
+        EXPECT_EQ (path.front(), a);
+        EXPECT_EQ (path.back(), b);
+        for (size_t j = 1; j < path.size(); ++j) {
+            ASSERT_TRUE (parents[path[j]] == path[j - 1] || parents[path[j - 1]] == path[j]);
+        }
+    }
+
+    // The root is an ancestor of every node, and a node of itself.
+    EXPECT_TRUE (index.is_ancestor_of (0, static_cast<node_id> (count - 1)));
+    EXPECT_TRUE (index.is_ancestor_of (7, 7));
+    EXPECT_EQ (index.path (7, 7), std::vector<node_id>{7});
+    EXPECT_EQ (index.parent (0), invalid_node);
+    EXPECT_EQ (index.depth (0), 0);
+
+    // A lone root.
+    const lca_index lone{tree<int>{"root"}};
+    EXPECT_EQ (lone.lowest_common_ancestor (0, 0), 0);
+    EXPECT_EQ (lone.path (0, 0), std::vector<node_id>{0});
+}
+
+TEST (SegmentTree, Queries) {
+    // Concatenation is not commutative, so it checks that ranges are
+    // combined in order.
+    segment_tree<std::string> st;
+    st.assign ({"a", "b", "c", "d", "e"});
+    EXPECT_EQ (st.query (0, 5), "abcde");
+    EXPECT_EQ (st.query (1, 4), "bcd");
+    EXPECT_EQ (st.query (2, 2), "");
+
+    st.set (3, "X");
+    EXPECT_EQ (st[3], "X");
+    EXPECT_EQ (st.query (0, 5), "abcXe");
+    EXPECT_EQ (st.query (3, 5), "Xe");
+}
+
+TEST (Tree, SubtreeAggregates) {
+    const size_t         count = 1000;
+    std::mt19937         gen{5};
+    std::vector<node_id> parents (count, invalid_node);
+
+    tree<int> tr{"0", 1};
+    for (size_t i = 1; i < count / 2; ++i) {
+        parents[i] = std::uniform_int_distribution<node_id>{0, static_cast<node_id> (i - 1)}(gen);
+        tr.append_node (parents[i], std::to_string (i), static_cast<int> (i % 17));
+    }
+
+    const auto max = [] (int a, int b) { return std::max (a, b); };
+
+    subtree_aggregate<int>                 sums{tr};
+    subtree_aggregate<int, decltype (max)> maxima{tr, max, std::numeric_limits<int>::min()};
+
+    const auto check = [&] {
+        // Subtree sums, maxima and sizes, gathered up the parent links.
+        const auto          n = tr.size();
+        std::vector<int>    sum (n), top (n);
+        std::vector<size_t> size (n, 1);
+        for (node_id i = 0; i < n; ++i) {
+            sum[i] = top[i] = *tr.data (i);
+        }
+        for (auto i = static_cast<node_id> (n - 1); i > 0; --i) {
+            sum[parents[i]] += sum[i];
+            top[parents[i]] = std::max (top[parents[i]], top[i]);
+            size[parents[i]] += size[i];
+        }
+        for (node_id i = 0; i < n; ++i) {
+            ASSERT_EQ (sums.value (i), sum[i]) << i;
+            ASSERT_EQ (maxima.value (i), top[i]) << i;
+            ASSERT_EQ (sums.size (i), size[i]) << i;
+        }
+    };
+    check();
+
+    // An aggregate follows the changes made through it at once, and those
+    // made through the tree or another aggregate after a reindex.
+    std::uniform_int_distribution<int>     value{-50, 50};
+    std::uniform_int_distribution<node_id> pick{0, static_cast<node_id> (tr.size() - 1)};
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_TRUE (sums.set_data (pick (gen), value (gen)));
+    }
+    maxima.reindex();
+    check();
+
+    const auto stale = sums.value (tr.root());
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_TRUE (tr.set_data (pick (gen), value (gen)));
+    }
+    EXPECT_TRUE (tr.set_data (tr.root(), stale + 1000));
+    EXPECT_EQ (sums.value (tr.root()), stale);
+    sums.reindex();
+    maxima.reindex();
+    check();
+
+    // Appended nodes are covered after a reindex, and not before.
+    for (size_t i = count / 2; i < count; ++i) {
+        parents[i] = std::uniform_int_distribution<node_id>{0, static_cast<node_id> (i - 1)}(gen);
+        tr.append_node (parents[i], std::to_string (i), value (gen));
+    }
+    EXPECT_EQ (sums.size(), count / 2);
+    EXPECT_EQ (sums.value (std::to_string (count - 1)), std::nullopt);
+    sums.reindex();
+    maxima.reindex();
+    EXPECT_EQ (sums.size(), count);
+    check();
+
+    EXPECT_EQ (sums.value ("0"), sums.value (tr.root()));
+    EXPECT_EQ (sums.value ("missing"), std::nullopt);
+    EXPECT_FALSE (sums.set_data ("missing", 1));
+    EXPECT_TRUE (sums.set_data ("0", 1000));
+    EXPECT_EQ (tr.data ("0"), 1000);
+}
+
+TEST (Tree, PathAggregates) {
+    const size_t count = 1000;
+    std::mt19937 gen{8};
+
+    // With the labels as data, concatenation along a root path spells the
+    // path, in order.
+    const auto random_parent = [&gen] (const size_t i) {
+        return std::uniform_int_distribution<node_id>{0, static_cast<node_id> (i - 1)}(gen);
+    };
+
+    tree<std::string> words{"0", "0"};
+    tree<int>         numbers{"0", 1};
+    for (size_t i = 1; i < count / 2; ++i) {
+        const auto parent = random_parent (i);
+        words.append_node (parent, std::to_string (i), std::to_string (i));
+        numbers.append_node (parent, std::to_string (i), static_cast<int> (i % 13));
+    }
+
+    const auto join = [] (const std::vector<std::string>& path) {
+        std::string joined;
+        for (const auto& label : path) {
+            joined += label;
+        }
+        return joined;
+    };
+
+    path_aggregate<std::string> spelled{words};
+    path_aggregate<int>         sums{numbers};
+
+    const auto check = [&] {
+        for (node_id i = 0; i < numbers.size(); ++i) {
+            ASSERT_EQ (spelled.value (i), join (words.path (std::string{*words.label (i)}))) << i;
+
+            int sum = 0;
+            for (const auto id : numbers.path (i)) {
+                sum += *numbers.data (id);
+            }
+            ASSERT_EQ (sums.value (i), sum) << i;
+        }
+    };
+    check();
+
+    // Point updates, then appends covered after a reindex.
+    std::uniform_int_distribution<node_id> pick{0, static_cast<node_id> (count / 2 - 1)};
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_TRUE (sums.set_data (pick (gen), i - 100));
+    }
+    for (size_t i = count / 2; i < count; ++i) {
+        const auto parent = random_parent (i);
+        words.append_node (parent, std::to_string (i), std::to_string (i));
+        numbers.append_node (parent, std::to_string (i), static_cast<int> (i % 13));
+    }
+    EXPECT_EQ (sums.size(), count / 2);
+    EXPECT_EQ (sums.value (std::to_string (count - 1)), std::nullopt);
+    spelled.reindex();
+    sums.reindex();
+    EXPECT_EQ (sums.size(), count);
+    check();
+
+    // Data changed through the tree is covered after a reindex.
+    const auto leaf = static_cast<node_id> (count - 1);
+    const auto old  = sums.value (leaf);
+    EXPECT_TRUE (numbers.set_data (numbers.root(), *numbers.data (numbers.root()) + 1000));
+    EXPECT_EQ (sums.value (leaf), old);
+    sums.reindex();
+    EXPECT_EQ (sums.value (leaf), old + 1000);
+    check();
+
+    EXPECT_EQ (spelled.value ("0"), "0");
+    EXPECT_EQ (sums.value ("missing"), std::nullopt);
+    EXPECT_FALSE (sums.set_data ("missing", 1));
+}